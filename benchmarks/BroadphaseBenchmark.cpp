@@ -0,0 +1,151 @@
+#include "../src/Physics/AABB.h"
+#include "../src/Physics/Broadphase.h"
+#include "../src/Physics/DynamicAABBTree.h"
+#include "../src/Physics/SpatialHashGrid.h"
+#include "../src/Physics/SweepAndPrune.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+struct Scene {
+  std::vector<AABB> boxes;
+  std::vector<glm::vec2> velocities;
+};
+
+// Mostly bullets and vehicles with a few large bases, spread so the density
+// stays the same at every object count.
+Scene
+CreateScene(unsigned int count) {
+  std::mt19937 rng(42);
+  const float worldSize = 60.0f * std::sqrt(static_cast<float>(count));
+  std::uniform_real_distribution<float> position(0.0f, worldSize);
+  std::uniform_real_distribution<float> speed(-4.0f, 4.0f);
+  std::uniform_real_distribution<float> kind(0.0f, 1.0f);
+
+  Scene scene;
+  for (unsigned int i = 0; i < count; i++) {
+    const float roll = kind(rng);
+    const float size = roll < 0.6f ? 4.0f : roll < 0.98f ? 32.0f : 256.0f;
+    const glm::vec2 min(position(rng), position(rng));
+
+    scene.boxes.push_back(AABB(min, min + glm::vec2(size, size)));
+    scene.velocities.push_back(size >= 256.0f ? glm::vec2(0, 0)
+                                              : glm::vec2(speed(rng), speed(rng)));
+  }
+  return scene;
+}
+
+void
+Step(Scene &scene) {
+  for (unsigned int i = 0; i < scene.boxes.size(); i++) {
+    scene.boxes[i].min += scene.velocities[i];
+    scene.boxes[i].max += scene.velocities[i];
+  }
+}
+
+size_t
+BruteForcePairs(const Scene &scene) {
+  size_t count = 0;
+  const auto &boxes = scene.boxes;
+  for (unsigned int i = 0; i < boxes.size(); i++) {
+    for (unsigned int j = i + 1; j < boxes.size(); j++) {
+      if (boxes[i].Overlaps(boxes[j])) {
+        count++;
+      }
+    }
+  }
+  return count;
+}
+
+size_t
+NarrowphasePairs(const Scene &scene, const std::vector<BroadphasePair> &pairs) {
+  size_t count = 0;
+  for (const auto &pair : pairs) {
+    if (scene.boxes[pair.a].Overlaps(scene.boxes[pair.b])) {
+      count++;
+    }
+  }
+  return count;
+}
+
+// Pair counts are taken from the first frame so every backend can be checked
+// against brute force, which only runs a few frames.
+void
+Report(const std::string &name, unsigned int count, unsigned int frames,
+       double milliseconds, size_t pairs) {
+  std::printf("%-18s %8u objects %10.3f ms/frame %10zu pairs\n", name.c_str(),
+              count, milliseconds / frames, pairs);
+}
+
+void
+RunBroadphase(const std::string &name, unsigned int count, unsigned int frames,
+              std::function<std::unique_ptr<IBroadphase>()> create) {
+  Scene scene = CreateScene(count);
+  auto broadphase = create();
+  for (unsigned int i = 0; i < count; i++) {
+    broadphase->Insert(i, scene.boxes[i]);
+  }
+
+  std::vector<BroadphasePair> pairs;
+  size_t overlaps = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (unsigned int frame = 0; frame < frames; frame++) {
+    Step(scene);
+    for (unsigned int i = 0; i < count; i++) {
+      broadphase->Move(i, scene.boxes[i]);
+    }
+
+    pairs.clear();
+    broadphase->ComputePairs(pairs);
+    if (frame == 0) {
+      overlaps = NarrowphasePairs(scene, pairs);
+    }
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  Report(name, count, frames,
+         std::chrono::duration<double, std::milli>(end - start).count(),
+         overlaps);
+}
+
+void
+RunBruteForce(unsigned int count, unsigned int frames) {
+  Scene scene = CreateScene(count);
+
+  size_t overlaps = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (unsigned int frame = 0; frame < frames; frame++) {
+    Step(scene);
+    const auto frameOverlaps = BruteForcePairs(scene);
+    if (frame == 0) {
+      overlaps = frameOverlaps;
+    }
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  Report("brute force", count, frames,
+         std::chrono::duration<double, std::milli>(end - start).count(),
+         overlaps);
+}
+
+int
+main(int argc, char *argv[]) {
+  const unsigned int frames = 60;
+
+  for (unsigned int count : {10000u, 100000u}) {
+    RunBruteForce(count, count > 10000 ? 1 : 5);
+    RunBroadphase("spatial hash grid", count, frames,
+                  [] { return std::make_unique<SpatialHashGrid>(); });
+    RunBroadphase("dynamic aabb tree", count, frames,
+                  [] { return std::make_unique<DynamicAABBTree>(); });
+    RunBroadphase("sweep and prune", count, frames,
+                  [] { return std::make_unique<SweepAndPrune>(); });
+  }
+
+  return 0;
+}
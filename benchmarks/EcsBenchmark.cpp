@@ -0,0 +1,178 @@
+#include "../src/Components/BoxColliderComponent.h"
+#include "../src/Components/RigidBodyComponent.h"
+#include "../src/Components/TransformComponent.h"
+#include "../src/ECS/ECS.h"
+#include "../src/Profiler/MemoryTracker.h"
+#include "../src/Profiler/Profiler.h"
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <spdlog/spdlog.h>
+#include <vector>
+
+class IntegrateSystem : public System {
+public:
+  IntegrateSystem() {
+    RequireComponent<TransformComponent>();
+    RequireComponent<RigidBodyComponent>();
+  }
+
+  void Update(float deltaTime) {
+    for (auto entity : GetSystemEntities()) {
+      auto &transform = entity.GetComponent<TransformComponent>();
+      const auto &rigidbody = entity.GetComponent<RigidBodyComponent>();
+      transform.position += rigidbody.velocity * deltaTime;
+    }
+  }
+};
+
+// No benchmark entity has a collider, so this system only costs its
+// signature test in AddEntityToSystems.
+class ColliderSystem : public System {
+public:
+  ColliderSystem() {
+    RequireComponent<TransformComponent>();
+    RequireComponent<BoxColliderComponent>();
+  }
+};
+
+template <typename TFunction>
+double
+MeasureMilliseconds(TFunction function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  const auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void
+Report(const char *name, unsigned int count, unsigned long operations,
+       double milliseconds) {
+  const double nanoseconds = milliseconds * 1e6 / operations;
+  std::printf("%-28s %8u entities %10.1f ns/op %14.0f ops/s\n", name, count,
+              nanoseconds, 1e9 / nanoseconds);
+}
+
+void
+ReportMemory(const Registry &registry) {
+  MemoryTracker tracker;
+  registry.ReportMemory(tracker);
+  for (const auto &usage : tracker.GetUsages()) {
+    std::printf("  %-16s %-24s %12zu used %12zu reserved\n", usage.category,
+                Profiler::Demangle(usage.name).c_str(), usage.usedBytes,
+                usage.reservedBytes);
+  }
+}
+
+// Entities with a transform and a rigid body, not yet handed to the
+// systems.
+std::unique_ptr<Registry>
+CreateRegistry(unsigned int count, std::vector<Entity> &entities,
+               bool isReported) {
+  auto registry = std::make_unique<Registry>();
+  registry->AddSystem<IntegrateSystem>();
+  registry->AddSystem<ColliderSystem>();
+
+  entities.clear();
+  entities.reserve(count);
+  const double createMilliseconds = MeasureMilliseconds([&] {
+    for (unsigned int i = 0; i < count; i++) {
+      entities.push_back(registry->CreateEntity());
+    }
+  });
+
+  const double addMilliseconds = MeasureMilliseconds([&] {
+    for (auto entity : entities) {
+      registry->AddComponent<TransformComponent>(
+          entity, glm::vec2(entity.GetId(), 0), glm::vec2(1, 1), 0.0);
+      registry->AddComponent<RigidBodyComponent>(entity, glm::vec2(1, 2));
+    }
+  });
+
+  if (isReported) {
+    Report("CreateEntity", count, count, createMilliseconds);
+    Report("AddComponent", count, count * 2ul, addMilliseconds);
+  }
+  return registry;
+}
+
+void
+RunBenchmarks(unsigned int count, unsigned int frames) {
+  std::vector<Entity> entities;
+  auto registry = CreateRegistry(count, entities, true);
+
+  bool hasAll = true;
+  const double hasMilliseconds = MeasureMilliseconds([&] {
+    for (auto entity : entities) {
+      hasAll &= registry->HasComponent<RigidBodyComponent>(entity);
+    }
+  });
+  Report("HasComponent", count, count, hasMilliseconds);
+
+  float sum = 0;
+  const double getMilliseconds = MeasureMilliseconds([&] {
+    for (auto entity : entities) {
+      sum += registry->GetComponent<TransformComponent>(entity).position.x;
+    }
+  });
+  Report("GetComponent", count, count, getMilliseconds);
+
+  const double updateMilliseconds =
+      MeasureMilliseconds([&] { registry->Update(); });
+  Report("Registry::Update (all new)", count, count, updateMilliseconds);
+
+  const double idleMilliseconds = MeasureMilliseconds([&] {
+    for (unsigned int frame = 0; frame < frames; frame++) {
+      registry->Update();
+    }
+  });
+  Report("Registry::Update (idle)", count, frames, idleMilliseconds);
+
+  auto &system = registry->GetSystem<IntegrateSystem>();
+  const double iterateMilliseconds = MeasureMilliseconds([&] {
+    for (unsigned int frame = 0; frame < frames; frame++) {
+      system.Update(1.0f / 60.0f);
+    }
+  });
+  Report("System iteration", count, static_cast<unsigned long>(count) * frames,
+         iterateMilliseconds);
+
+  const double removeMilliseconds = MeasureMilliseconds([&] {
+    for (auto entity : entities) {
+      registry->RemoveComponent<RigidBodyComponent>(entity);
+    }
+  });
+  Report("RemoveComponent", count, count, removeMilliseconds);
+
+  // Removed rigid bodies still hold their slots.
+  std::printf("Memory after RemoveComponent\n");
+  ReportMemory(*registry);
+
+  // A registry of its own, as its entities must not be in the systems yet.
+  auto pending = CreateRegistry(count, entities, false);
+  const double systemsMilliseconds = MeasureMilliseconds([&] {
+    for (auto entity : entities) {
+      pending->AddEntityToSystems(entity);
+    }
+  });
+  Report("AddEntityToSystems", count, count, systemsMilliseconds);
+
+  // Keeps the reads from being optimized away.
+  if (!hasAll || sum < 0) {
+    std::printf("unexpected components\n");
+  }
+  std::printf("\n");
+}
+
+int
+main(int argc, char *argv[]) {
+  // Registry logs every entity and component; formatting still runs, but
+  // nothing is written.
+  spdlog::set_level(spdlog::level::off);
+
+  for (unsigned int count : {1000u, 100000u, 1000000u}) {
+    RunBenchmarks(count, count >= 1000000 ? 10 : 100);
+  }
+
+  return 0;
+}
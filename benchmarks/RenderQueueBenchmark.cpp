@@ -0,0 +1,105 @@
+#include "../src/Renderer/RenderQueue.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Sprites spread over a few layers and a 1080 pixel tall screen, drawn from
+// a handful of textures, like a busy frame of the game.
+std::vector<uint64_t>
+CreateKeys(unsigned int count) {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> layer(0, 3);
+  std::uniform_real_distribution<float> depth(0.0f, 1080.0f);
+  std::uniform_int_distribution<unsigned int> texture(1, 8);
+
+  std::vector<uint64_t> keys;
+  for (unsigned int i = 0; i < count; i++) {
+    keys.push_back(RenderQueue::MakeKey(layer(rng), depth(rng), texture(rng),
+                                        SDL_BLENDMODE_BLEND));
+  }
+  return keys;
+}
+
+void
+Report(const char *name, unsigned int count, unsigned int frames,
+       double milliseconds, bool isSorted) {
+  std::printf("%-18s %8u items %10.3f ms/frame %s\n", name, count,
+              milliseconds / frames, isSorted ? "sorted" : "NOT SORTED");
+}
+
+void
+RunRadixSort(const std::vector<uint64_t> &keys, unsigned int frames) {
+  RenderQueue queue;
+
+  double milliseconds = 0;
+  for (unsigned int frame = 0; frame < frames; frame++) {
+    queue.Begin();
+    for (unsigned int i = 0; i < keys.size(); i++) {
+      // The source x tags each item with its push order.
+      RenderItem item = {};
+      item.srcRect.x = i;
+      queue.Push(keys[i], item);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    queue.Sort();
+    const auto end = std::chrono::steady_clock::now();
+    milliseconds +=
+        std::chrono::duration<double, std::milli>(end - start).count();
+  }
+
+  std::vector<std::pair<uint64_t, unsigned int>> expected;
+  for (unsigned int i = 0; i < keys.size(); i++) {
+    expected.push_back({keys[i], i});
+  }
+  std::stable_sort(
+      expected.begin(), expected.end(),
+      [](const auto &a, const auto &b) { return a.first < b.first; });
+
+  bool isSorted = true;
+  for (unsigned int i = 0; i < expected.size(); i++) {
+    isSorted &= queue.GetSorted(i).srcRect.x ==
+                static_cast<int>(expected[i].second);
+  }
+
+  Report("radix sort", keys.size(), frames, milliseconds, isSorted);
+}
+
+void
+RunStdSort(const std::vector<uint64_t> &keys, unsigned int frames) {
+  std::vector<std::pair<uint64_t, unsigned int>> pairs;
+
+  double milliseconds = 0;
+  for (unsigned int frame = 0; frame < frames; frame++) {
+    pairs.clear();
+    for (unsigned int i = 0; i < keys.size(); i++) {
+      pairs.push_back({keys[i], i});
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::stable_sort(
+        pairs.begin(), pairs.end(),
+        [](const auto &a, const auto &b) { return a.first < b.first; });
+    const auto end = std::chrono::steady_clock::now();
+    milliseconds +=
+        std::chrono::duration<double, std::milli>(end - start).count();
+  }
+
+  Report("std::stable_sort", keys.size(), frames, milliseconds, true);
+}
+
+int
+main(int argc, char *argv[]) {
+  const unsigned int frames = 100;
+
+  for (unsigned int count : {10000u, 50000u, 200000u}) {
+    const auto keys = CreateKeys(count);
+    RunStdSort(keys, frames);
+    RunRadixSort(keys, frames);
+  }
+
+  return 0;
+}
@@ -0,0 +1,24 @@
+#ifndef ASSETHANDLE_H
+#define ASSETHANDLE_H
+
+// Refers to a slot in the AssetStore. The generation changes whenever a slot
+// is freed, so a handle to a released asset resolves to nothing instead of to
+// whatever reused the slot.
+struct AssetHandle {
+  unsigned int index;
+  unsigned int generation;
+
+  AssetHandle(unsigned int index = ~0u, unsigned int generation = 0) {
+    this->index = index;
+    this->generation = generation;
+  }
+
+  bool IsValid() const { return index != ~0u; }
+
+  bool operator==(const AssetHandle &other) const {
+    return index == other.index && generation == other.generation;
+  }
+  bool operator!=(const AssetHandle &other) const { return !(*this == other); }
+};
+
+#endif
@@ -0,0 +1,554 @@
+#include "AssetStore.h"
+#include "../Profiler/MemoryTracker.h"
+#include "../Profiler/Profiler.h"
+#include <SDL2/SDL_image.h>
+#include <filesystem>
+#include <spdlog/spdlog.h>
+
+std::mutex AssetStore::fontMutex;
+
+// Copies a surface into a texture, or into a rectangle of it, when the sizes
+// match. The surface is converted to the texture's own pixel format first.
+static bool
+UpdateTexture(SDL_Texture *texture, SDL_Surface *surface,
+              const SDL_Rect *rect) {
+  Uint32 format;
+  int width, height;
+  if (!texture ||
+      SDL_QueryTexture(texture, &format, nullptr, &width, &height) != 0) {
+    return false;
+  }
+  if (rect) {
+    width = rect->w;
+    height = rect->h;
+  }
+  if (surface->w != width || surface->h != height) {
+    return false;
+  }
+
+  SDL_Surface *converted = SDL_ConvertSurfaceFormat(surface, format, 0);
+  if (!converted) {
+    return false;
+  }
+  const bool isUpdated = SDL_UpdateTexture(texture, rect, converted->pixels,
+                                           converted->pitch) == 0;
+  SDL_FreeSurface(converted);
+  return isUpdated;
+}
+
+AssetStore::AssetStore(unsigned int workerCount) {
+  for (unsigned int i = 0; i < workerCount; i++) {
+    workers.emplace_back(&AssetStore::WorkerLoop, this);
+  }
+  spdlog::info("AssetStore constructor called");
+}
+
+AssetStore::~AssetStore() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    isStopping = true;
+  }
+  jobAvailable.notify_all();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  Clear();
+  spdlog::info("AssetStore destructor called");
+}
+
+AssetHandle
+AssetStore::CreateAsset(AssetType type, const std::string &assetId,
+                        const std::string &filePath, int fontSize) {
+  unsigned int index;
+  if (!freeSlots.empty()) {
+    index = freeSlots.back();
+    freeSlots.pop_back();
+  } else {
+    index = assets.size();
+    assets.push_back({});
+    assets[index].generation = 0;
+  }
+
+  auto &asset = assets[index];
+  asset.type = type;
+  asset.state = AssetState::Loading;
+  asset.assetId = assetId;
+  asset.filePath = filePath;
+  asset.fontSize = fontSize;
+  asset.refCount = 1;
+  asset.revision = 0;
+  asset.texture = nullptr;
+  asset.sound = nullptr;
+  asset.font = nullptr;
+
+  indexOfAssetId[assetId] = index;
+  return AssetHandle(index, asset.generation);
+}
+
+void
+AssetStore::QueueDecode(AssetHandle handle, bool isReload, SDL_Rect region) {
+  const auto &asset = assets[handle.index];
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.push_back({handle, asset.type, asset.filePath, asset.fontSize,
+                    isReload, region});
+  }
+  jobAvailable.notify_one();
+}
+
+AssetHandle
+AssetStore::LoadTexture(const std::string &assetId,
+                        const std::string &filePath) {
+  if (indexOfAssetId.count(assetId)) {
+    return Acquire(assetId);
+  }
+
+  const auto handle = CreateAsset(AssetType::Texture, assetId, filePath, 0);
+  QueueDecode(handle);
+  return handle;
+}
+
+AssetHandle
+AssetStore::LoadSound(const std::string &assetId,
+                      const std::string &filePath) {
+  if (indexOfAssetId.count(assetId)) {
+    return Acquire(assetId);
+  }
+
+  const auto handle = CreateAsset(AssetType::Sound, assetId, filePath, 0);
+  QueueDecode(handle);
+  return handle;
+}
+
+AssetHandle
+AssetStore::LoadFont(const std::string &assetId, const std::string &filePath,
+                     int fontSize) {
+  if (indexOfAssetId.count(assetId)) {
+    return Acquire(assetId);
+  }
+
+  const auto handle =
+      CreateAsset(AssetType::Font, assetId, filePath, fontSize);
+  QueueDecode(handle);
+  return handle;
+}
+
+AssetHandle
+AssetStore::AddTexture(const std::string &assetId, SDL_Surface *surface) {
+  if (indexOfAssetId.count(assetId)) {
+    SDL_FreeSurface(surface);
+    return Acquire(assetId);
+  }
+
+  const auto handle = CreateAsset(AssetType::Texture, assetId, "", 0);
+  uploads.push_back({handle, AssetType::Texture, false, {0, 0, 0, 0}, surface,
+                     nullptr, nullptr});
+  return handle;
+}
+
+bool
+AssetStore::Reload(const std::string &filePath) {
+  const auto path = std::filesystem::path(filePath).lexically_normal();
+
+  bool isFound = false;
+  for (unsigned int index = 0; index < assets.size(); index++) {
+    const auto &asset = assets[index];
+    // Assets still loading will read the new file anyway.
+    if (asset.refCount == 0 || asset.state == AssetState::Loading ||
+        asset.filePath.empty() ||
+        std::filesystem::path(asset.filePath).lexically_normal() != path) {
+      continue;
+    }
+
+    QueueDecode(AssetHandle(index, asset.generation), true);
+    isFound = true;
+  }
+  return isFound;
+}
+
+void
+AssetStore::ReloadRegion(AssetHandle texture, const SDL_Rect &region,
+                         const std::string &filePath) {
+  const auto asset = Find(texture);
+  if (!asset || asset->type != AssetType::Texture) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.push_back({texture, AssetType::Texture, filePath, 0, true, region});
+  }
+  jobAvailable.notify_one();
+}
+
+AssetHandle
+AssetStore::Acquire(const std::string &assetId) {
+  const auto index = indexOfAssetId.find(assetId);
+  if (index == indexOfAssetId.end()) {
+    return AssetHandle();
+  }
+
+  auto &asset = assets[index->second];
+  asset.refCount++;
+  return AssetHandle(index->second, asset.generation);
+}
+
+void
+AssetStore::Release(AssetHandle handle) {
+  auto asset = Find(handle);
+  if (!asset || --asset->refCount > 0) {
+    return;
+  }
+
+  FreeAsset(*asset);
+  indexOfAssetId.erase(asset->assetId);
+  asset->generation++;
+  freeSlots.push_back(handle.index);
+}
+
+void
+AssetStore::FreeAsset(Asset &asset) {
+  if (asset.texture) {
+    SDL_DestroyTexture(asset.texture);
+    asset.texture = nullptr;
+  }
+  if (asset.sound) {
+    Mix_FreeChunk(asset.sound);
+    asset.sound = nullptr;
+  }
+  if (asset.font) {
+    CloseFont(asset.font);
+    asset.font = nullptr;
+  }
+}
+
+AssetStore::Asset *
+AssetStore::Find(AssetHandle handle) {
+  if (handle.index >= assets.size() ||
+      assets[handle.index].generation != handle.generation ||
+      assets[handle.index].refCount == 0) {
+    return nullptr;
+  }
+  return &assets[handle.index];
+}
+
+const AssetStore::Asset *
+AssetStore::Find(AssetHandle handle) const {
+  if (handle.index >= assets.size() ||
+      assets[handle.index].generation != handle.generation ||
+      assets[handle.index].refCount == 0) {
+    return nullptr;
+  }
+  return &assets[handle.index];
+}
+
+SDL_Texture *
+AssetStore::GetTexture(AssetHandle handle) const {
+  const auto asset = Find(handle);
+  return asset ? asset->texture : nullptr;
+}
+
+Mix_Chunk *
+AssetStore::GetSound(AssetHandle handle) const {
+  const auto asset = Find(handle);
+  return asset ? asset->sound : nullptr;
+}
+
+TTF_Font *
+AssetStore::GetFont(AssetHandle handle) const {
+  const auto asset = Find(handle);
+  return asset ? asset->font : nullptr;
+}
+
+AssetState
+AssetStore::GetState(AssetHandle handle) const {
+  const auto asset = Find(handle);
+  return asset ? asset->state : AssetState::Failed;
+}
+
+unsigned int
+AssetStore::GetRevision(AssetHandle handle) const {
+  const auto asset = Find(handle);
+  return asset ? asset->revision : 0;
+}
+
+unsigned int
+AssetStore::GetPendingCount() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return jobs.size() + busyWorkers + decoded.size() + uploads.size();
+}
+
+void
+AssetStore::ReportMemory(MemoryTracker &tracker) const {
+  size_t textureBytes = 0;
+  size_t soundBytes = 0;
+  for (const auto &asset : assets) {
+    if (asset.texture) {
+      Uint32 format;
+      int width;
+      int height;
+      SDL_QueryTexture(asset.texture, &format, nullptr, &width, &height);
+      textureBytes += static_cast<size_t>(width) * height *
+                      SDL_BYTESPERPIXEL(format);
+    }
+    if (asset.sound) {
+      soundBytes += asset.sound->alen;
+    }
+  }
+
+  tracker.Record("Assets", "Textures", textureBytes, textureBytes);
+  tracker.Record("Assets", "Sounds", soundBytes, soundBytes);
+  tracker.Record("Assets", "Asset slots", assets.capacity() * sizeof(Asset),
+                 (assets.size() - freeSlots.size()) * sizeof(Asset));
+}
+
+void
+AssetStore::WorkerLoop() {
+  PROFILE_THREAD("AssetWorker");
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    jobAvailable.wait(lock, [this] { return isStopping || !jobs.empty(); });
+    if (isStopping) {
+      return;
+    }
+
+    const DecodeJob job = jobs.front();
+    jobs.pop_front();
+    busyWorkers++;
+
+    lock.unlock();
+    DecodeResult result = Decode(job);
+    lock.lock();
+
+    decoded.push_back(result);
+    busyWorkers--;
+    if (busyWorkers == 0 && jobs.empty()) {
+      workersIdle.notify_all();
+    }
+  }
+}
+
+AssetStore::DecodeResult
+AssetStore::Decode(const DecodeJob &job) {
+  PROFILE_SCOPE("AssetStore::Decode");
+  DecodeResult result = {job.handle, job.type, job.isReload, job.region,
+                         nullptr,    nullptr,  nullptr};
+
+  switch (job.type) {
+  case AssetType::Texture: {
+    SDL_Surface *loaded = IMG_Load(job.filePath.c_str());
+    if (loaded) {
+      result.surface =
+          SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+      SDL_FreeSurface(loaded);
+
+      if (!result.surface) {
+        spdlog::error("Error converting texture " + job.filePath + ": " +
+                      SDL_GetError());
+      } else if (job.region.w > 0 && (result.surface->w != job.region.w ||
+                                      result.surface->h != job.region.h)) {
+        spdlog::warn("Atlas image " + job.filePath +
+                     " changed size, repack the atlas to reload it");
+        SDL_FreeSurface(result.surface);
+        result.surface = nullptr;
+      }
+    } else {
+      spdlog::error("Error loading texture " + job.filePath + ": " +
+                    IMG_GetError());
+    }
+    break;
+  }
+  case AssetType::Sound:
+    result.sound = Mix_LoadWAV(job.filePath.c_str());
+    if (!result.sound) {
+      spdlog::error("Error loading sound " + job.filePath + ": " +
+                    Mix_GetError());
+    }
+    break;
+  case AssetType::Font: {
+    std::lock_guard<std::mutex> lock(fontMutex);
+    result.font = TTF_OpenFont(job.filePath.c_str(), job.fontSize);
+    if (!result.font) {
+      spdlog::error("Error loading font " + job.filePath + ": " +
+                    TTF_GetError());
+    }
+    break;
+  }
+  }
+
+  return result;
+}
+
+void
+AssetStore::CloseFont(TTF_Font *font) {
+  std::lock_guard<std::mutex> lock(fontMutex);
+  TTF_CloseFont(font);
+}
+
+void
+AssetStore::FreeResult(DecodeResult &result) {
+  if (result.surface) {
+    SDL_FreeSurface(result.surface);
+  }
+  if (result.sound) {
+    Mix_FreeChunk(result.sound);
+  }
+  if (result.font) {
+    CloseFont(result.font);
+  }
+}
+
+bool
+AssetStore::Finish(DecodeResult &result, SDL_Renderer *renderer) {
+  auto asset = Find(result.handle);
+  if (!asset) {
+    FreeResult(result);
+    return false;
+  }
+  if (result.isReload) {
+    FinishReload(result, *asset, renderer);
+    return result.type == AssetType::Texture;
+  }
+
+  bool isLoaded = false;
+  switch (result.type) {
+  case AssetType::Texture:
+    if (result.surface) {
+      asset->texture = SDL_CreateTextureFromSurface(renderer, result.surface);
+      SDL_FreeSurface(result.surface);
+      isLoaded = asset->texture != nullptr;
+    }
+    break;
+  case AssetType::Sound:
+    asset->sound = result.sound;
+    isLoaded = asset->sound != nullptr;
+    break;
+  case AssetType::Font:
+    asset->font = result.font;
+    isLoaded = asset->font != nullptr;
+    break;
+  }
+
+  asset->state = isLoaded ? AssetState::Ready : AssetState::Failed;
+  return result.type == AssetType::Texture;
+}
+
+// A failed decode, often a file caught halfway through being written, keeps
+// the current asset; the next write triggers another reload.
+void
+AssetStore::FinishReload(DecodeResult &result, Asset &asset,
+                         SDL_Renderer *renderer) {
+  bool isReloaded = false;
+
+  switch (result.type) {
+  case AssetType::Texture: {
+    if (!result.surface) {
+      break;
+    }
+
+    const bool isRegion = result.region.w > 0;
+    if (UpdateTexture(asset.texture, result.surface,
+                      isRegion ? &result.region : nullptr)) {
+      isReloaded = true;
+    } else if (!isRegion) {
+      // The image changed size; replace the texture behind the same handle.
+      SDL_Texture *texture =
+          SDL_CreateTextureFromSurface(renderer, result.surface);
+      if (texture) {
+        if (asset.texture) {
+          SDL_DestroyTexture(asset.texture);
+        }
+        asset.texture = texture;
+        isReloaded = true;
+      }
+    }
+    SDL_FreeSurface(result.surface);
+    break;
+  }
+  case AssetType::Sound:
+    if (result.sound) {
+      if (asset.sound) {
+        Mix_FreeChunk(asset.sound);
+      }
+      asset.sound = result.sound;
+      isReloaded = true;
+    }
+    break;
+  case AssetType::Font:
+    if (result.font) {
+      if (asset.font) {
+        CloseFont(asset.font);
+      }
+      asset.font = result.font;
+      isReloaded = true;
+    }
+    break;
+  }
+
+  if (isReloaded) {
+    asset.state = AssetState::Ready;
+    asset.revision++;
+    spdlog::info("Reloaded asset " + asset.assetId);
+  }
+}
+
+void
+AssetStore::Update(SDL_Renderer *renderer, double budgetMilliseconds) {
+  PROFILE_SCOPE("AssetStore::Update");
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    uploads.insert(uploads.end(), decoded.begin(), decoded.end());
+    decoded.clear();
+  }
+
+  // Sounds and fonts are ready as decoded; only texture uploads count against
+  // the budget, and at least one runs per frame so loading always advances.
+  const Uint64 start = SDL_GetPerformanceCounter();
+  const double countsPerMillisecond = SDL_GetPerformanceFrequency() / 1000.0;
+  bool hasUploaded = false;
+
+  while (!uploads.empty()) {
+    if (hasUploaded && (SDL_GetPerformanceCounter() - start) /
+                               countsPerMillisecond >=
+                           budgetMilliseconds) {
+      break;
+    }
+
+    DecodeResult result = uploads.front();
+    uploads.pop_front();
+    hasUploaded |= Finish(result, renderer);
+  }
+}
+
+void
+AssetStore::Clear() {
+  std::vector<DecodeResult> inFlight;
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    jobs.clear();
+    workersIdle.wait(lock, [this] { return busyWorkers == 0; });
+    inFlight.swap(decoded);
+  }
+
+  for (auto &result : inFlight) {
+    FreeResult(result);
+  }
+  for (auto &result : uploads) {
+    FreeResult(result);
+  }
+  uploads.clear();
+
+  for (unsigned int index = 0; index < assets.size(); index++) {
+    auto &asset = assets[index];
+    if (asset.refCount == 0) {
+      continue;
+    }
+
+    FreeAsset(asset);
+    asset.refCount = 0;
+    asset.generation++;
+    freeSlots.push_back(index);
+  }
+  indexOfAssetId.clear();
+}
@@ -0,0 +1,139 @@
+#ifndef ASSETSTORE_H
+#define ASSETSTORE_H
+
+#include "AssetHandle.h"
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+#include <SDL2/SDL_ttf.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class MemoryTracker;
+
+const unsigned int ASSET_WORKER_COUNT = 2;
+const double ASSET_UPLOAD_BUDGET_MS = 2.0;
+
+enum class AssetType { Texture, Sound, Font };
+
+enum class AssetState { Loading, Ready, Failed };
+
+// Reference counted textures, sounds and fonts addressed by handle. Files are
+// decoded on worker threads; textures are then uploaded on the main thread by
+// Update, which stops once its per-frame time budget is spent. IMG_Load and
+// Mix_LoadWAV run in parallel; fonts share one FreeType library, so opening and
+// closing them is serialized by fontMutex.
+class AssetStore {
+private:
+  struct Asset {
+    AssetType type;
+    AssetState state;
+    std::string assetId;
+    std::string filePath;
+    int fontSize;
+    unsigned int generation;
+    unsigned int refCount;
+    unsigned int revision; // bumped by every reload
+
+    SDL_Texture *texture;
+    Mix_Chunk *sound;
+    TTF_Font *font;
+  };
+
+  // A reload replaces a ready asset behind its handle; a non-empty region
+  // limits a texture reload to that rectangle.
+  struct DecodeJob {
+    AssetHandle handle;
+    AssetType type;
+    std::string filePath;
+    int fontSize;
+    bool isReload;
+    SDL_Rect region;
+  };
+
+  struct DecodeResult {
+    AssetHandle handle;
+    AssetType type;
+    bool isReload;
+    SDL_Rect region;
+    SDL_Surface *surface;
+    Mix_Chunk *sound;
+    TTF_Font *font;
+  };
+
+  // Only touched by the main thread.
+  std::vector<Asset> assets;
+  std::vector<unsigned int> freeSlots;
+  std::unordered_map<std::string, unsigned int> indexOfAssetId;
+  std::deque<DecodeResult> uploads;
+
+  // Shared with the workers, guarded by mutex.
+  std::mutex mutex;
+  std::condition_variable jobAvailable;
+  std::condition_variable workersIdle;
+  std::deque<DecodeJob> jobs;
+  std::vector<DecodeResult> decoded;
+  unsigned int busyWorkers = 0;
+  bool isStopping = false;
+
+  std::vector<std::thread> workers;
+
+  static std::mutex fontMutex;
+
+  AssetHandle CreateAsset(AssetType type, const std::string &assetId,
+                          const std::string &filePath, int fontSize);
+  void QueueDecode(AssetHandle handle, bool isReload = false,
+                   SDL_Rect region = {0, 0, 0, 0});
+  void WorkerLoop();
+  static DecodeResult Decode(const DecodeJob &job);
+  static void FreeResult(DecodeResult &result);
+  static void CloseFont(TTF_Font *font);
+  void FreeAsset(Asset &asset);
+  bool Finish(DecodeResult &result, SDL_Renderer *renderer);
+  void FinishReload(DecodeResult &result, Asset &asset,
+                    SDL_Renderer *renderer);
+  Asset *Find(AssetHandle handle);
+  const Asset *Find(AssetHandle handle) const;
+
+public:
+  AssetStore(unsigned int workerCount = ASSET_WORKER_COUNT);
+  ~AssetStore();
+
+  AssetHandle LoadTexture(const std::string &assetId,
+                          const std::string &filePath);
+  AssetHandle LoadSound(const std::string &assetId,
+                        const std::string &filePath);
+  AssetHandle LoadFont(const std::string &assetId, const std::string &filePath,
+                       int fontSize);
+  AssetHandle AddTexture(const std::string &assetId, SDL_Surface *surface);
+
+  // Queues a fresh decode of every ready asset loaded from filePath; the result
+  // is swapped in place by Update, so existing handles stay valid.
+  bool Reload(const std::string &filePath);
+  void ReloadRegion(AssetHandle texture, const SDL_Rect &region,
+                    const std::string &filePath);
+
+  AssetHandle Acquire(const std::string &assetId);
+  void Release(AssetHandle handle);
+
+  SDL_Texture *GetTexture(AssetHandle handle) const;
+  Mix_Chunk *GetSound(AssetHandle handle) const;
+  TTF_Font *GetFont(AssetHandle handle) const;
+  AssetState GetState(AssetHandle handle) const;
+  unsigned int GetRevision(AssetHandle handle) const;
+  unsigned int GetPendingCount();
+
+  // Reports texture, sound and slot memory. Texture sizes are the pixels
+  // uploaded, so drivers may hold more; font sizes are not known to SDL_ttf.
+  void ReportMemory(MemoryTracker &tracker) const;
+
+  void Update(SDL_Renderer *renderer,
+              double budgetMilliseconds = ASSET_UPLOAD_BUDGET_MS);
+  void Clear();
+};
+
+#endif
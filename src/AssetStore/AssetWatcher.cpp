@@ -0,0 +1,112 @@
+#include "AssetWatcher.h"
+#include <algorithm>
+#include <filesystem>
+#include <spdlog/spdlog.h>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+AssetWatcher::AssetWatcher(const std::string &rootDirectory) {
+#ifdef __linux__
+  fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd < 0) {
+    spdlog::error(std::string("Error starting asset watcher: ") +
+                  std::strerror(errno));
+    return;
+  }
+
+  // inotify is not recursive: every directory of the tree gets its own watch.
+  WatchDirectory(rootDirectory);
+  std::error_code error;
+  for (const auto &entry :
+       std::filesystem::recursive_directory_iterator(rootDirectory, error)) {
+    if (entry.is_directory()) {
+      WatchDirectory(entry.path().string());
+    }
+  }
+  spdlog::info("Watching " + rootDirectory + " for asset changes");
+#else
+  spdlog::warn("Asset hot reload is not supported on this platform");
+#endif
+}
+
+AssetWatcher::~AssetWatcher() {
+#ifdef __linux__
+  if (fd >= 0) {
+    close(fd);
+  }
+#endif
+}
+
+void
+AssetWatcher::WatchDirectory(const std::string &directory) {
+#ifdef __linux__
+  const int watch =
+      inotify_add_watch(fd, directory.c_str(),
+                        IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR);
+  if (watch < 0) {
+    spdlog::error("Error watching " + directory + ": " + std::strerror(errno));
+    return;
+  }
+  directoryOfWatch[watch] = directory;
+#endif
+}
+
+const std::vector<std::string> &
+AssetWatcher::Poll() {
+  changedFiles.clear();
+#ifdef __linux__
+  if (fd < 0) {
+    return changedFiles;
+  }
+
+  alignas(inotify_event) char buffer[4096];
+  while (true) {
+    const ssize_t length = read(fd, buffer, sizeof(buffer));
+    if (length <= 0) {
+      break;
+    }
+
+    for (ssize_t offset = 0; offset < length;) {
+      const auto event = reinterpret_cast<inotify_event *>(buffer + offset);
+      offset += sizeof(inotify_event) + event->len;
+
+      if (event->mask & IN_IGNORED) {
+        directoryOfWatch.erase(event->wd);
+        continue;
+      }
+      const auto directory = directoryOfWatch.find(event->wd);
+      if (directory == directoryOfWatch.end() || event->len == 0) {
+        continue;
+      }
+
+      const std::string path =
+          (std::filesystem::path(directory->second) / event->name)
+              .lexically_normal()
+              .string();
+      if (event->mask & IN_ISDIR) {
+        if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+          WatchDirectory(path);
+        }
+        continue;
+      }
+      // A new file is reported again once it is closed after writing.
+      if (event->mask & IN_CREATE) {
+        continue;
+      }
+
+      // Editors often write a file several times in a row; one reload is
+      // enough.
+      if (std::find(changedFiles.begin(), changedFiles.end(), path) ==
+          changedFiles.end()) {
+        changedFiles.push_back(path);
+      }
+    }
+  }
+#endif
+  return changedFiles;
+}
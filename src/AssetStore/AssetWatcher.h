@@ -0,0 +1,33 @@
+#ifndef ASSETWATCHER_H
+#define ASSETWATCHER_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Reports files written under a directory tree, for hot reloading. Uses
+// inotify without blocking, so Poll can run every frame; elsewhere than Linux
+// it never reports anything.
+class AssetWatcher {
+private:
+  int fd = -1;
+  std::unordered_map<int, std::string> directoryOfWatch;
+  std::vector<std::string> changedFiles;
+
+  void WatchDirectory(const std::string &directory);
+
+public:
+  AssetWatcher(const std::string &rootDirectory);
+  ~AssetWatcher();
+
+  AssetWatcher(const AssetWatcher &) = delete;
+  AssetWatcher &operator=(const AssetWatcher &) = delete;
+
+  bool IsWatching() const { return fd >= 0; }
+
+  // Files finished writing or moved into place since the last call, each
+  // listed once and normalized as in AssetStore::Reload.
+  const std::vector<std::string> &Poll();
+};
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef ANIMATIONCOMPONENT_H
+#define ANIMATIONCOMPONENT_H
+
+// The starting state of an animation. Once the entity is in the
+// AnimationSystem, playback lives there; change it through Play and
+// SetPlaybackRate.
+struct AnimationComponent {
+  unsigned int clipId;
+  double frameTime; // seconds into the clip
+  float playbackRate;
+  bool isLooping;
+
+  AnimationComponent(unsigned int clipId = 0, float playbackRate = 1.0f,
+                     bool isLooping = true, double frameTime = 0.0) {
+    this->clipId = clipId;
+    this->frameTime = frameTime;
+    this->playbackRate = playbackRate;
+    this->isLooping = isLooping;
+  }
+};
+
+#endif
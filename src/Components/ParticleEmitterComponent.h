@@ -0,0 +1,30 @@
+#ifndef PARTICLEEMITTERCOMPONENT_H
+#define PARTICLEEMITTERCOMPONENT_H
+
+#include <glm/glm.hpp>
+
+// Emits particles of one ParticleSystem effect from the entity's position.
+// The burst is emitted once, on the first update after it is set.
+struct ParticleEmitterComponent {
+  unsigned int effectId;
+  float particlesPerSecond;
+  unsigned int burstCount;
+  glm::vec2 offset; // from the entity's position
+  bool isEmitting;
+  float emitAccumulator; // particles owed from earlier updates
+
+  ParticleEmitterComponent(unsigned int effectId = 0,
+                           float particlesPerSecond = 0.0f,
+                           unsigned int burstCount = 0,
+                           glm::vec2 offset = glm::vec2(0, 0),
+                           bool isEmitting = true) {
+    this->effectId = effectId;
+    this->particlesPerSecond = particlesPerSecond;
+    this->burstCount = burstCount;
+    this->offset = offset;
+    this->isEmitting = isEmitting;
+    this->emitAccumulator = 0.0f;
+  }
+};
+
+#endif
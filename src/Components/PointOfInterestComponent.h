@@ -0,0 +1,16 @@
+#ifndef POINTOFINTERESTCOMPONENT_H
+#define POINTOFINTERESTCOMPONENT_H
+
+#include "../Tilemap/Tilemap.h"
+
+// Keeps streamed tilemaps resident around the entity, within radius chunks,
+// so it can be simulated away from the camera.
+struct PointOfInterestComponent {
+  int radius;
+
+  PointOfInterestComponent(int radius = TILEMAP_STREAMING_RADIUS) {
+    this->radius = radius;
+  }
+};
+
+#endif
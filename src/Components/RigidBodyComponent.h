@@ -5,9 +5,13 @@
 
 struct RigidBodyComponent {
   glm::vec2 velocity;
+  bool isSleeping;
+  float sleepTimer;
 
   RigidBodyComponent(glm::vec2 velocity = glm::vec2(0, 0)) {
     this->velocity = velocity;
+    this->isSleeping = false;
+    this->sleepTimer = 0;
   }
 };
 
@@ -1,16 +1,32 @@
 #ifndef SPRITECOMPONENT_H
 #define SPRITECOMPONENT_H
 
+#include "../AssetStore/AssetHandle.h"
+#include <SDL2/SDL.h>
 #include <glm/glm.hpp>
 
 struct SpriteComponent {
   int width;
   int height;
+  int zIndex;          // render layer, from -128 to 127
+  AssetHandle texture; // an invalid handle draws a solid rectangle
+  SDL_Rect srcRect;    // empty uses the whole texture
+  SDL_Color color;
+  SDL_BlendMode blendMode;
 
-  SpriteComponent(int width = 10, int height = 10) {
+  SpriteComponent(int width = 10, int height = 10, int zIndex = 0,
+                  AssetHandle texture = AssetHandle(),
+                  SDL_Rect srcRect = {0, 0, 0, 0},
+                  SDL_Color color = {255, 255, 255, 255},
+                  SDL_BlendMode blendMode = SDL_BLENDMODE_BLEND) {
     this->width = width;
     this->height = height;
+    this->zIndex = zIndex;
+    this->texture = texture;
+    this->srcRect = srcRect;
+    this->color = color;
+    this->blendMode = blendMode;
   }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,23 @@
+#ifndef TILEMAPCOMPONENT_H
+#define TILEMAPCOMPONENT_H
+
+#include "../AssetStore/AssetHandle.h"
+#include "../Tilemap/Tilemap.h"
+#include <memory>
+
+// The map is drawn with its top-left corner at the entity's position and
+// scaled by its scale.
+struct TilemapComponent {
+  std::shared_ptr<Tilemap> tilemap;
+  AssetHandle tileset;
+  int tileSize;
+
+  TilemapComponent(std::shared_ptr<Tilemap> tilemap = nullptr,
+                   AssetHandle tileset = AssetHandle(), int tileSize = 32) {
+    this->tilemap = tilemap;
+    this->tileset = tileset;
+    this->tileSize = tileSize;
+  }
+};
+
+#endif
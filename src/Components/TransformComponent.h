@@ -8,11 +8,26 @@ struct TransformComponent {
   glm::vec2 scale;
   double rotation;
 
+  // State at the start of the current simulation tick, blended with the
+  // current state when rendering between ticks.
+  glm::vec2 previousPosition;
+  double previousRotation;
+
   TransformComponent(glm::vec2 position = glm::vec2(0, 0),
                      glm::vec2 scale = glm::vec2(1, 1), double rotation = 0) {
     this->position = position;
     this->scale = scale;
     this->rotation = rotation;
+    this->previousPosition = position;
+    this->previousRotation = rotation;
+  }
+
+  glm::vec2 InterpolatedPosition(double alpha) const {
+    return glm::mix(previousPosition, position, static_cast<float>(alpha));
+  }
+
+  double InterpolatedRotation(double alpha) const {
+    return previousRotation + (rotation - previousRotation) * alpha;
   }
 };
 
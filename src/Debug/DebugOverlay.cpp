@@ -0,0 +1,240 @@
+#include "DebugOverlay.h"
+#include "../Profiler/Profiler.h"
+#include <algorithm>
+#include <imgui/imgui.h>
+#include <spdlog/spdlog.h>
+
+DebugOverlay::DebugOverlay(SDL_Renderer *renderer) {
+  context = ImGui::CreateContext();
+  ImGuiIO &io = ImGui::GetIO();
+  io.IniFilename = nullptr;
+
+  unsigned char *pixels;
+  int width;
+  int height;
+  io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+  fontTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32,
+                                  SDL_TEXTUREACCESS_STATIC, width, height);
+  if (!fontTexture) {
+    spdlog::error("Error creating the debug overlay font texture");
+  } else {
+    SDL_UpdateTexture(fontTexture, nullptr, pixels, width * 4);
+    SDL_SetTextureBlendMode(fontTexture, SDL_BLENDMODE_BLEND);
+  }
+  io.Fonts->TexID = fontTexture;
+
+  countPreviousFrame = SDL_GetPerformanceCounter();
+}
+
+DebugOverlay::~DebugOverlay() {
+  ImGui::DestroyContext(context);
+  if (fontTexture) {
+    SDL_DestroyTexture(fontTexture);
+  }
+}
+
+void
+DebugOverlay::ProcessEvent(const SDL_Event &event) {
+  ImGuiIO &io = ImGui::GetIO();
+  switch (event.type) {
+  case SDL_MOUSEWHEEL:
+    io.MouseWheel += event.wheel.y;
+    break;
+  case SDL_MOUSEBUTTONDOWN:
+    // Kept until the next frame, so clicks shorter than a frame count.
+    if (event.button.button >= 1 && event.button.button <= 3) {
+      isMousePressed[event.button.button - 1] = true;
+    }
+    break;
+  }
+}
+
+void
+DebugOverlay::Render(SDL_Renderer *renderer, const Registry &registry,
+                     const MemoryTracker &memoryTracker, int width,
+                     int height) {
+  const Uint64 count = SDL_GetPerformanceCounter();
+  const double deltaTime = static_cast<double>(count - countPreviousFrame) /
+                           SDL_GetPerformanceFrequency();
+  countPreviousFrame = count;
+
+  if (!isVisible) {
+    drawCallCount = 0;
+    return;
+  }
+  PROFILE_SCOPE("DebugOverlay::Render");
+
+  ImGuiIO &io = ImGui::GetIO();
+  io.DisplaySize = ImVec2(width, height);
+  io.DeltaTime = std::max(deltaTime, 1e-6);
+
+  int mouseX;
+  int mouseY;
+  const Uint32 buttons = SDL_GetMouseState(&mouseX, &mouseY);
+  io.MousePos = ImVec2(mouseX, mouseY);
+  for (int i = 0; i < 3; i++) {
+    io.MouseDown[i] = isMousePressed[i] || (buttons & SDL_BUTTON(i + 1));
+    isMousePressed[i] = false;
+  }
+
+  ImGui::NewFrame();
+  ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
+  ImGui::SetNextWindowSize(ImVec2(340, 420), ImGuiCond_FirstUseEver);
+  ImGui::SetNextWindowBgAlpha(0.85f);
+  if (ImGui::Begin("Performance (F1)", &isVisible)) {
+    DrawProfiler();
+    DrawRegistry(registry);
+    DrawMemory(memoryTracker);
+  }
+  ImGui::End();
+  ImGui::Render();
+
+  if (renderer) {
+    Submit(renderer, *ImGui::GetDrawData());
+  }
+}
+
+void
+DebugOverlay::DrawProfiler() {
+  const auto &frames = Profiler::GetFrames();
+  if (frames.empty()) {
+    ImGui::TextUnformatted("Profiler disabled (build with ENABLE_PROFILER)");
+    return;
+  }
+
+  frameTimes.clear();
+  float total = 0;
+  float slowest = 0;
+  for (const auto &frame : frames) {
+    const float milliseconds =
+        Profiler::ToMilliseconds(frame.end - frame.start);
+    frameTimes.push_back(milliseconds);
+    total += milliseconds;
+    slowest = std::max(slowest, milliseconds);
+  }
+
+  ImGui::Text("Frame %.2f ms, mean %.2f ms, max %.2f ms", frameTimes.back(),
+              total / frameTimes.size(), slowest);
+  ImGui::PlotLines("##frameTimes", frameTimes.data(), frameTimes.size(), 0,
+                   nullptr, 0.0f, slowest * 1.1f, ImVec2(-1, 60));
+
+  const auto &lastFrame = frames.back();
+  for (const auto &counter : lastFrame.counters) {
+    ImGui::Text("%s: %g", counter.name, counter.value);
+  }
+  ImGui::Text("Overlay draw calls: %u", drawCallCount);
+
+  if (ImGui::CollapsingHeader("Zones", ImGuiTreeNodeFlags_DefaultOpen)) {
+    ImGui::Columns(3, "zones");
+    ImGui::SetColumnWidth(0, 200);
+    ImGui::TextUnformatted("Zone");
+    ImGui::NextColumn();
+    ImGui::TextUnformatted("ms");
+    ImGui::NextColumn();
+    ImGui::TextUnformatted("calls");
+    ImGui::NextColumn();
+    for (const auto &total : lastFrame.totals) {
+      ImGui::TextUnformatted(total.name);
+      ImGui::NextColumn();
+      ImGui::Text("%.3f", total.milliseconds);
+      ImGui::NextColumn();
+      ImGui::Text("%u", total.calls);
+      ImGui::NextColumn();
+    }
+    ImGui::Columns(1);
+  }
+}
+
+void
+DebugOverlay::DrawRegistry(const Registry &registry) {
+  ImGui::Text("Entities: %u", registry.GetEntityCount());
+
+  if (ImGui::CollapsingHeader("Systems")) {
+    for (const auto &system : registry.GetSystems()) {
+      ImGui::Text("%-24s %6zu entities",
+                  Profiler::Demangle(system.first.name()).c_str(),
+                  system.second->GetSystemEntities().size());
+    }
+  }
+
+  if (ImGui::CollapsingHeader("Component pools")) {
+    for (const auto &pool : registry.GetComponentPools()) {
+      if (pool) {
+        ImGui::Text("%-24s %7u slots",
+                    Profiler::Demangle(pool->GetTypeName()).c_str(),
+                    pool->GetSize());
+      }
+    }
+  }
+}
+
+void
+DebugOverlay::DrawMemory(const MemoryTracker &memoryTracker) {
+  ImGui::Text("Memory: %.1f KB used of %.1f KB reserved",
+              memoryTracker.GetUsedBytes() / 1024.0,
+              memoryTracker.GetReservedBytes() / 1024.0);
+  if (!ImGui::CollapsingHeader("Memory (KB)")) {
+    return;
+  }
+
+  ImGui::Columns(4, "memory");
+  ImGui::SetColumnWidth(0, 160);
+  ImGui::TextUnformatted("Container");
+  ImGui::NextColumn();
+  ImGui::TextUnformatted("used");
+  ImGui::NextColumn();
+  ImGui::TextUnformatted("reserved");
+  ImGui::NextColumn();
+  ImGui::TextUnformatted("peak");
+  ImGui::NextColumn();
+  for (const auto &usage : memoryTracker.GetUsages()) {
+    ImGui::TextUnformatted(Profiler::Demangle(usage.name).c_str());
+    if (ImGui::IsItemHovered()) {
+      ImGui::SetTooltip("%s", usage.category);
+    }
+    ImGui::NextColumn();
+    ImGui::Text("%.1f", usage.usedBytes / 1024.0);
+    ImGui::NextColumn();
+    ImGui::Text("%.1f", usage.reservedBytes / 1024.0);
+    ImGui::NextColumn();
+    ImGui::Text("%.1f", usage.peakReservedBytes / 1024.0);
+    ImGui::NextColumn();
+  }
+  ImGui::Columns(1);
+}
+
+// ImGui merges consecutive primitives with the same texture and clip rect
+// into one command, so a window costs a handful of calls. ImGui packs colors
+// with red in the low byte, which is SDL_Color's layout on little-endian
+// machines, so its vertices are used as they are.
+void
+DebugOverlay::Submit(SDL_Renderer *renderer, const ImDrawData &drawData) {
+  drawCallCount = 0;
+  for (int i = 0; i < drawData.CmdListsCount; i++) {
+    const ImDrawList *list = drawData.CmdLists[i];
+    for (const auto &command : list->CmdBuffer) {
+      const SDL_Rect clip = {
+          static_cast<int>(command.ClipRect.x),
+          static_cast<int>(command.ClipRect.y),
+          static_cast<int>(command.ClipRect.z - command.ClipRect.x),
+          static_cast<int>(command.ClipRect.w - command.ClipRect.y)};
+      if (clip.w <= 0 || clip.h <= 0) {
+        continue;
+      }
+
+      const ImDrawVert *vertices = list->VtxBuffer.Data + command.VtxOffset;
+      SDL_RenderSetClipRect(renderer, &clip);
+      SDL_RenderGeometryRaw(
+          renderer, static_cast<SDL_Texture *>(command.TextureId),
+          &vertices->pos.x, sizeof(ImDrawVert),
+          reinterpret_cast<const SDL_Color *>(&vertices->col),
+          sizeof(ImDrawVert), &vertices->uv.x, sizeof(ImDrawVert),
+          list->VtxBuffer.Size - command.VtxOffset,
+          list->IdxBuffer.Data + command.IdxOffset, command.ElemCount,
+          sizeof(ImDrawIdx));
+      drawCallCount++;
+    }
+  }
+  SDL_RenderSetClipRect(renderer, nullptr);
+}
@@ -0,0 +1,50 @@
+#ifndef DEBUGOVERLAY_H
+#define DEBUGOVERLAY_H
+
+#include "../ECS/ECS.h"
+#include "../Profiler/MemoryTracker.h"
+#include <SDL2/SDL.h>
+#include <vector>
+
+struct ImDrawData;
+struct ImGuiContext;
+
+// An ImGui window over the game with frame times and zones from the
+// profiler, entity counts per system and tracked memory. ImGui's draw
+// lists go straight to SDL_RenderGeometryRaw, one call per draw command;
+// imgui_sdl draws every triangle with its own copy and is not used.
+class DebugOverlay {
+private:
+  ImGuiContext *context;
+  SDL_Texture *fontTexture = nullptr;
+  Uint64 countPreviousFrame = 0;
+  bool isMousePressed[3] = {false, false, false};
+
+  std::vector<float> frameTimes;
+  unsigned int drawCallCount = 0;
+
+  void DrawProfiler();
+  void DrawRegistry(const Registry &registry);
+  void DrawMemory(const MemoryTracker &memoryTracker);
+  void Submit(SDL_Renderer *renderer, const ImDrawData &drawData);
+
+public:
+  DebugOverlay(SDL_Renderer *renderer);
+  ~DebugOverlay();
+
+  DebugOverlay(const DebugOverlay &) = delete;
+  DebugOverlay &operator=(const DebugOverlay &) = delete;
+
+  bool isVisible = false;
+
+  // Passes mouse input on to ImGui; call for every event.
+  void ProcessEvent(const SDL_Event &event);
+
+  // Draws the overlay over the frame when it is visible.
+  void Render(SDL_Renderer *renderer, const Registry &registry,
+              const MemoryTracker &memoryTracker, int width, int height);
+
+  unsigned int GetDrawCallCount() const { return drawCallCount; }
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "ECS.h"
+#include "../Profiler/MemoryTracker.h"
 #include <algorithm>
 #include <spdlog/spdlog.h>
 
@@ -22,7 +23,7 @@ System::RemoveEntityFromSystem(Entity entity) {
       entities.end());
 }
 
-std::vector<Entity>
+const std::vector<Entity> &
 System::GetSystemEntities() const {
   return entities;
 }
@@ -40,6 +41,7 @@ Registry::CreateEntity() {
   entity.registry = this;
 
   entitiesToBeAdded.insert(entity);
+  PROFILE_EVENT("CreateEntity", nullptr, entityId);
 
   if (entityId >= entityComponentSignatures.size()) {
     entityComponentSignatures.resize(entityId + 1);
@@ -50,13 +52,42 @@ Registry::CreateEntity() {
   return entity;
 }
 
-template <typename TComponent>
-bool
-Registry::HasComponent(Entity entity) const {
-  const auto componentId = Component<TComponent>::GetId();
-  const auto entityId = entity.GetId();
+unsigned int
+Registry::GetEntityCount() const {
+  return numEntities;
+}
+
+const std::vector<std::shared_ptr<IPool>> &
+Registry::GetComponentPools() const {
+  return componentPools;
+}
+
+const std::unordered_map<std::type_index, std::shared_ptr<System>> &
+Registry::GetSystems() const {
+  return systems;
+}
+
+void
+Registry::ReportMemory(MemoryTracker &tracker) const {
+  for (unsigned int i = 0; i < componentPools.size(); i++) {
+    const auto &pool = componentPools[i];
+    if (pool) {
+      tracker.Record("Component pools", pool->GetTypeName(),
+                     pool->GetReservedBytes(),
+                     componentCounts[i] * pool->GetElementSize());
+    }
+  }
+
+  for (const auto &system : systems) {
+    const auto &entities = system.second->GetSystemEntities();
+    tracker.Record("System entities", system.first.name(),
+                   entities.capacity() * sizeof(Entity),
+                   entities.size() * sizeof(Entity));
+  }
 
-  return entityComponentSignatures[entityId].test(componentId);
+  tracker.Record("Registry", "Signatures",
+                 entityComponentSignatures.capacity() * sizeof(Signature),
+                 numEntities * sizeof(Signature));
 }
 
 void
@@ -74,12 +105,14 @@ Registry::AddEntityToSystems(Entity entity) {
 
     if (isInterested) {
       system.second->AddEntityToSystem(entity);
+      PROFILE_EVENT("AddEntityToSystem", system.first.name(), entityId);
     }
   }
 }
 
 void
 Registry::Update() {
+  PROFILE_SCOPE("Registry::Update");
   for (auto entity : entitiesToBeAdded) {
     AddEntityToSystems(entity);
   }
@@ -1,6 +1,7 @@
 #ifndef ECS_H
 #define ECS_H
 
+#include "../Profiler/Profiler.h"
 #include <bitset>
 #include <set>
 #include <spdlog/spdlog.h>
@@ -10,6 +11,8 @@
 
 const unsigned int MAX_COMPONENTS = 32;
 
+class MemoryTracker;
+
 typedef std::bitset<MAX_COMPONENTS> Signature;
 
 struct IComponent {
@@ -54,11 +57,11 @@ private:
 
 public:
   System() = default;
-  ~System() = default;
+  virtual ~System() = default;
 
-  void AddEntityToSystem(Entity entity);
-  void RemoveEntityFromSystem(Entity entity);
-  std::vector<Entity> GetSystemEntities() const;
+  virtual void AddEntityToSystem(Entity entity);
+  virtual void RemoveEntityFromSystem(Entity entity);
+  const std::vector<Entity> &GetSystemEntities() const;
   const Signature &GetComponentSignature() const;
 
   template <typename T> void RequireComponent();
@@ -67,6 +70,11 @@ public:
 class IPool {
 public:
   virtual ~IPool() {}
+
+  virtual const char *GetTypeName() const = 0;
+  virtual unsigned int GetSize() const = 0;
+  virtual size_t GetElementSize() const = 0;
+  virtual size_t GetReservedBytes() const = 0;
 };
 
 template <typename T> class Pool : public IPool {
@@ -79,7 +87,15 @@ public:
 
   bool IsEmpty() const { return data.empty(); }
 
-  unsigned int GetSize() const { return data.size(); }
+  const char *GetTypeName() const override { return typeid(T).name(); }
+
+  unsigned int GetSize() const override { return data.size(); }
+
+  size_t GetElementSize() const override { return sizeof(T); }
+
+  size_t GetReservedBytes() const override {
+    return data.capacity() * sizeof(T);
+  }
 
   void Resize(unsigned int n) { data.resize(n); }
 
@@ -101,6 +117,8 @@ private:
   std::set<Entity> entitiesToBeKilled;
 
   std::vector<std::shared_ptr<IPool>> componentPools;
+  // Entities with each component; pools have a slot for every entity.
+  std::vector<unsigned int> componentCounts;
 
   std::vector<Signature> entityComponentSignatures;
 
@@ -111,6 +129,13 @@ public:
   ~Registry() { spdlog::info("Registry destructor called"); }
 
   Entity CreateEntity();
+  unsigned int GetEntityCount() const;
+  const std::vector<std::shared_ptr<IPool>> &GetComponentPools() const;
+  const std::unordered_map<std::type_index, std::shared_ptr<System>> &
+  GetSystems() const;
+
+  // Reports each component pool, system entity list and the signatures.
+  void ReportMemory(MemoryTracker &tracker) const;
 
   void Update();
 
@@ -173,6 +198,7 @@ Registry::AddComponent(Entity entity, TArgs &&...args) {
 
   if (componentId >= componentPools.size()) {
     componentPools.resize(componentId + 1, nullptr);
+    componentCounts.resize(componentId + 1, 0);
   }
 
   if (!componentPools[componentId]) {
@@ -192,7 +218,11 @@ Registry::AddComponent(Entity entity, TArgs &&...args) {
 
   componentPool->Set(entityId, newComponent);
 
+  if (!entityComponentSignatures[entityId].test(componentId)) {
+    componentCounts[componentId]++;
+  }
   entityComponentSignatures[entityId].set(componentId);
+  PROFILE_EVENT("AddComponent", typeid(TComponent).name(), entityId);
 
   spdlog::info("Component id =  " + std::to_string(componentId) +
                " was added to entity id " + std::to_string(entityId));
@@ -204,12 +234,25 @@ Registry::RemoveComponent(Entity entity) {
   const auto componentId = Component<TComponent>::GetId();
   const auto entityId = entity.GetId();
 
+  if (entityComponentSignatures[entityId].test(componentId)) {
+    componentCounts[componentId]--;
+  }
   entityComponentSignatures[entityId].set(componentId, false);
+  PROFILE_EVENT("RemoveComponent", typeid(TComponent).name(), entityId);
 
   spdlog::info("Component id =  " + std::to_string(componentId) +
                " was removed to entity id " + std::to_string(entityId));
 }
 
+template <typename TComponent>
+bool
+Registry::HasComponent(Entity entity) const {
+  const auto componentId = Component<TComponent>::GetId();
+  const auto entityId = entity.GetId();
+
+  return entityComponentSignatures[entityId].test(componentId);
+}
+
 template <typename TComponent>
 TComponent &
 Registry::GetComponent(Entity entity) const {
@@ -217,7 +260,7 @@ Registry::GetComponent(Entity entity) const {
   const auto entityId = entity.GetId();
 
   auto componentPool =
-      std::static_pointer_cast<Pool<TComponent>>(componentPools[componentId]);
+      static_cast<Pool<TComponent> *>(componentPools[componentId].get());
 
   return componentPool->Get(entityId);
 }
@@ -0,0 +1,225 @@
+#include "Game.h"
+#include "../Components/BoxColliderComponent.h"
+#include "../Components/ParticleEmitterComponent.h"
+#include "../Components/RigidBodyComponent.h"
+#include "../Components/SpriteComponent.h"
+#include "../Components/TransformComponent.h"
+#include "../Profiler/Profiler.h"
+#include "../Systems/ParticleSystem.h"
+#include "../Systems/RenderSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <spdlog/spdlog.h>
+#include <sys/resource.h>
+#include <vector>
+
+// Nearest rank, so the reported value is always a measured frame.
+static double
+Percentile(std::vector<double> samples, double percentile) {
+  if (samples.empty()) {
+    return 0;
+  }
+  std::sort(samples.begin(), samples.end());
+  const auto rank =
+      static_cast<size_t>(std::ceil(percentile / 100.0 * samples.size()));
+  return samples[std::max<size_t>(rank, 1) - 1];
+}
+
+static double
+Mean(const std::vector<double> &samples) {
+  double sum = 0;
+  for (auto sample : samples) {
+    sum += sample;
+  }
+  return samples.empty() ? 0 : sum / samples.size();
+}
+
+static long
+PeakMemoryBytes() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss * 1024L; // kilobytes on Linux
+}
+
+bool
+Game::SetupBenchmark(const BenchmarkOptions &options) {
+  const bool hasColliders = options.scenario == "collisions";
+  const bool hasParticles = options.scenario == "particles";
+  if (options.scenario != "sprites" && !hasColliders && !hasParticles) {
+    spdlog::critical("Unknown benchmark scenario " + options.scenario +
+                     ", expected sprites, collisions or particles");
+    return false;
+  }
+
+  unsigned int dustId = 0;
+  if (hasParticles) {
+    ParticleEffect dust;
+    dust.minLifetime = 0.4f;
+    dust.maxLifetime = 0.8f;
+    dust.maxSpeed = 15.0f;
+    dust.drag = 2.0f;
+    dust.startSize = 3.0f;
+    dust.endSize = 8.0f;
+    dust.startColor = {150, 120, 80, 160};
+    dust.endColor = {150, 120, 80, 0};
+    dustId = registry->GetSystem<ParticleSystem>().AddEffect(
+        dust, options.entityCount * 10);
+  }
+
+  // About one entity per 48x48 pixel cell, with the camera over the middle.
+  const float worldSize =
+      std::sqrt(static_cast<float>(options.entityCount)) * 48;
+  camera.position = glm::vec2(worldSize * 0.5f) -
+                    glm::vec2(windowWidth, windowHeight) * 0.5f;
+
+  std::mt19937 rng(options.seed);
+  std::uniform_real_distribution<float> position(0.0f, worldSize);
+  std::uniform_real_distribution<float> velocity(-100.0f, 100.0f);
+
+  const AtlasRegion regions[2] = {atlas.GetRegion("tank-panther-right"),
+                                  atlas.GetRegion("truck-ford-right")};
+  for (unsigned int i = 0; i < options.entityCount; i++) {
+    const auto &region = regions[i % 2];
+    Entity entity = registry->CreateEntity();
+    entity.AddComponent<TransformComponent>(
+        glm::vec2(position(rng), position(rng)), glm::vec2(1.0, 1.0), 0);
+    entity.AddComponent<RigidBodyComponent>(
+        glm::vec2(velocity(rng), velocity(rng)));
+    entity.AddComponent<SpriteComponent>(32, 32, 1, region.texture,
+                                         region.rect);
+    if (hasColliders) {
+      entity.AddComponent<BoxColliderComponent>(32, 32);
+    }
+    if (hasParticles) {
+      entity.AddComponent<ParticleEmitterComponent>(dustId, 10.0f, 0,
+                                                    glm::vec2(16, 16));
+    }
+  }
+
+  registry->Update();
+  return true;
+}
+
+int
+Game::RunBenchmark(const BenchmarkOptions &options) {
+  SetupSystems();
+  if (!isRunning || !SetupBenchmark(options)) {
+    return 1;
+  }
+
+  const double deltaTime = 1.0 / tickRate;
+  interpolationAlpha = 1.0;
+  flightRecorder = std::make_unique<FlightRecorder>(frameBudget);
+
+  std::vector<double> frameTimes;
+  frameTimes.reserve(options.frameCount);
+  // Zone totals by name, in the order each zone was first seen.
+  std::vector<const char *> zoneNames;
+  std::vector<std::vector<double>> zoneTimes;
+  unsigned long drawCalls = 0;
+
+  for (unsigned int frame = 0;
+       frame < BENCHMARK_WARMUP_FRAMES + options.frameCount; frame++) {
+    const auto start = std::chrono::steady_clock::now();
+    FixedUpdate(deltaTime);
+    Animate(deltaTime);
+    Render();
+    const auto end = std::chrono::steady_clock::now();
+    TrackMemory();
+    PROFILE_FRAME();
+    flightRecorder->Update();
+
+    if (frame < BENCHMARK_WARMUP_FRAMES) {
+      continue;
+    }
+
+    frameTimes.push_back(
+        std::chrono::duration<double, std::milli>(end - start).count());
+
+    for (const auto &total : Profiler::GetLastFrame().totals) {
+      unsigned int i = 0;
+      while (i < zoneNames.size() && std::strcmp(zoneNames[i], total.name)) {
+        i++;
+      }
+      if (i == zoneNames.size()) {
+        zoneNames.push_back(total.name);
+        zoneTimes.emplace_back();
+      }
+      zoneTimes[i].push_back(total.milliseconds);
+    }
+
+    drawCalls += registry->GetSystem<RenderSystem>()
+                     .GetSpriteBatch()
+                     .GetDrawCallCount() +
+                 registry->GetSystem<ParticleSystem>().GetDrawCallCount();
+  }
+
+  FILE *output = stdout;
+  if (!options.outputPath.empty()) {
+    output = std::fopen(options.outputPath.c_str(), "w");
+    if (!output) {
+      spdlog::critical("Error opening benchmark output " + options.outputPath);
+      return 1;
+    }
+  }
+
+  std::fprintf(output, "{\n");
+  std::fprintf(output, "  \"scenario\": \"%s\",\n", options.scenario.c_str());
+  std::fprintf(output, "  \"entities\": %u,\n", options.entityCount);
+  std::fprintf(output, "  \"frames\": %u,\n", options.frameCount);
+  std::fprintf(output, "  \"warmupFrames\": %u,\n", BENCHMARK_WARMUP_FRAMES);
+  std::fprintf(output, "  \"tickRate\": %d,\n", tickRate);
+  std::fprintf(output, "  \"seed\": %u,\n", options.seed);
+  std::fprintf(output,
+               "  \"frameTimeMs\": {\"mean\": %.4f, \"p50\": %.4f, "
+               "\"p99\": %.4f, \"p99.9\": %.4f, \"max\": %.4f},\n",
+               Mean(frameTimes), Percentile(frameTimes, 50),
+               Percentile(frameTimes, 99), Percentile(frameTimes, 99.9),
+               Percentile(frameTimes, 100));
+
+  std::fprintf(output, "  \"systemsMs\": {");
+  for (unsigned int i = 0; i < zoneTimes.size(); i++) {
+    // A zone missing from some frames has fewer samples; its mean still
+    // counts every measured frame.
+    const double sum = Mean(zoneTimes[i]) * zoneTimes[i].size();
+    std::fprintf(output, "%s\n    \"%s\": {\"mean\": %.4f, \"p99\": %.4f}",
+                 i > 0 ? "," : "", zoneNames[i],
+                 frameTimes.empty() ? 0 : sum / frameTimes.size(),
+                 Percentile(zoneTimes[i], 99));
+  }
+  std::fprintf(output, "\n  },\n");
+
+  std::fprintf(output, "  \"drawCallsPerFrame\": %.2f,\n",
+               frameTimes.empty()
+                   ? 0.0
+                   : static_cast<double>(drawCalls) / frameTimes.size());
+  std::fprintf(output, "  \"peakMemoryBytes\": %ld,\n", PeakMemoryBytes());
+
+  const auto &usages = memoryTracker.GetUsages();
+  std::fprintf(output,
+               "  \"trackedMemoryBytes\": {\"reserved\": %zu, "
+               "\"used\": %zu},\n",
+               memoryTracker.GetReservedBytes(), memoryTracker.GetUsedBytes());
+  std::fprintf(output, "  \"memory\": [");
+  for (unsigned int i = 0; i < usages.size(); i++) {
+    const auto &usage = usages[i];
+    std::fprintf(output,
+                 "%s\n    {\"category\": \"%s\", \"name\": \"%s\", "
+                 "\"reserved\": %zu, \"used\": %zu, \"peakReserved\": %zu, "
+                 "\"peakUsed\": %zu}",
+                 i > 0 ? "," : "", usage.category,
+                 Profiler::Demangle(usage.name).c_str(), usage.reservedBytes,
+                 usage.usedBytes, usage.peakReservedBytes, usage.peakUsedBytes);
+  }
+  std::fprintf(output, "\n  ]\n");
+  std::fprintf(output, "}\n");
+
+  if (output != stdout) {
+    std::fclose(output);
+  }
+  return 0;
+}
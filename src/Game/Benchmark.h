@@ -0,0 +1,24 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <string>
+
+const unsigned int BENCHMARK_ENTITY_COUNT = 10000;
+const unsigned int BENCHMARK_FRAME_COUNT = 1000;
+const unsigned int BENCHMARK_WARMUP_FRAMES = 60; // run but not measured
+
+// A headless run of a generated scene at a fixed timestep, one simulation
+// tick per frame, reported as JSON. Scenarios spawn entityCount tanks and
+// trucks with random velocities:
+//   sprites     moving sprites only
+//   collisions  moving sprites with box colliders
+//   particles   moving sprites, each trailing dust
+struct BenchmarkOptions {
+  std::string scenario;
+  unsigned int entityCount = BENCHMARK_ENTITY_COUNT;
+  unsigned int frameCount = BENCHMARK_FRAME_COUNT;
+  unsigned int seed = 1;
+  std::string outputPath; // empty writes to stdout
+};
+
+#endif
@@ -1,46 +1,178 @@
 #include "Game.h"
+#include "../Components/AnimationComponent.h"
+#include "../Components/BoxColliderComponent.h"
+#include "../Components/ParticleEmitterComponent.h"
+#include "../Components/PointOfInterestComponent.h"
 #include "../Components/RigidBodyComponent.h"
 #include "../Components/SpriteComponent.h"
+#include "../Components/TilemapComponent.h"
 #include "../Components/TransformComponent.h"
 #include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
+#include "../Systems/AnimationSystem.h"
+#include "../Systems/CollisionSystem.h"
 #include "../Systems/MovementSystem.h"
+#include "../Systems/ParticleSystem.h"
+#include "../Systems/PointOfInterestSystem.h"
 #include "../Systems/RenderSystem.h"
+#include "../Systems/TilemapSystem.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
+#include <SDL2/SDL_mixer.h>
+#include <SDL2/SDL_ttf.h>
+#include <cmath>
+#include <filesystem>
 #include <glm/glm.hpp>
 #include <iostream>
 #include <memory>
 #include <spdlog/spdlog.h>
 
 Game::Game() {
+  PROFILE_THREAD("Main");
   isRunning = false;
+  window = nullptr;
+  renderer = nullptr;
 
   registry = std::make_unique<Registry>();
+  assetStore = std::make_unique<AssetStore>();
 
   spdlog::info("Game constructor called!");
 }
 
 void
-Game::Setup() {
+Game::SetupSystems() {
   registry->AddSystem<MovementSystem>();
   registry->AddSystem<RenderSystem>();
+  registry->AddSystem<CollisionSystem>();
+  registry->AddSystem<TilemapSystem>();
+  registry->AddSystem<PointOfInterestSystem>();
+  registry->AddSystem<AnimationSystem>();
+  registry->AddSystem<ParticleSystem>();
+
+  if (!atlas.Load("./assets/atlas/sprites")) {
+    spdlog::warn("Prebuilt atlas not found, packing assets/images at startup");
+    atlas.Pack("./assets/images");
+  }
+  atlas.Upload(*assetStore);
+}
 
+void
+Game::Setup() {
+  SetupSystems();
+
+  if (HOT_RELOAD && !isHeadless) {
+    assetWatcher = std::make_unique<AssetWatcher>("./assets");
+  }
+
+  assetStore->LoadSound("helicopter-sound", "./assets/sounds/helicopter.wav");
+  assetStore->LoadFont("charriot-font", "./assets/fonts/charriot.ttf", 14);
+
+  // The binary map is built by `make tilemaps` and streamed in around the
+  // camera; the CSV source is the fallback.
+  auto jungle = std::make_shared<Tilemap>();
+  const bool isJungleLoaded =
+      std::filesystem::exists("./assets/tilemaps/jungle.tmap")
+          ? jungle->OpenStreaming("./assets/tilemaps/jungle.tmap")
+          : jungle->Load("./assets/tilemaps/jungle.map");
+  if (isJungleLoaded) {
+    Entity map = registry->CreateEntity();
+    map.AddComponent<TransformComponent>(glm::vec2(0.0, 0.0),
+                                         glm::vec2(2.0, 2.0), 0);
+    map.AddComponent<TilemapComponent>(
+        jungle,
+        assetStore->LoadTexture("jungle-tileset",
+                                "./assets/tilemaps/jungle.png"),
+        32);
+  }
+
+  const auto tankRegion = atlas.GetRegion("tank-panther-down");
   Entity tank = registry->CreateEntity();
   tank.AddComponent<TransformComponent>(glm::vec2(10.0, 30.0),
                                         glm::vec2(1.0, 1.0), 0);
   tank.AddComponent<RigidBodyComponent>(glm::vec2(0.0, 100.0));
-  tank.AddComponent<SpriteComponent>(30, 30);
+  tank.AddComponent<SpriteComponent>(32, 32, 1, tankRegion.texture,
+                                     tankRegion.rect);
+  tank.AddComponent<BoxColliderComponent>(32, 32);
+  tank.AddComponent<PointOfInterestComponent>();
 
+  const auto truckRegion = atlas.GetRegion("truck-ford-right");
   Entity truck = registry->CreateEntity();
   truck.AddComponent<TransformComponent>(glm::vec2(10.0, 30.0),
                                          glm::vec2(1.0, 1.0), 0);
   truck.AddComponent<RigidBodyComponent>(glm::vec2(100.0, 0.0));
-  truck.AddComponent<SpriteComponent>(20, 20);
+  truck.AddComponent<SpriteComponent>(32, 32, 1, truckRegion.texture,
+                                      truckRegion.rect);
+  truck.AddComponent<BoxColliderComponent>(32, 32);
+  truck.AddComponent<PointOfInterestComponent>();
+
+  // The chopper sheet has two rotor frames per row, one row per heading:
+  // up, right, down, left.
+  auto &animationSystem = registry->GetSystem<AnimationSystem>();
+  const auto chopperRegion = atlas.GetRegion("chopper-spritesheet");
+  const unsigned int chopperRight = animationSystem.AddClip(
+      AnimationSystem::GridFrames(chopperRegion.rect, 32, 32, 2, 2), 15.0f);
+  Entity chopper = registry->CreateEntity();
+  chopper.AddComponent<TransformComponent>(glm::vec2(10.0, 100.0),
+                                           glm::vec2(1.0, 1.0), 0);
+  chopper.AddComponent<RigidBodyComponent>(glm::vec2(50.0, 0.0));
+  chopper.AddComponent<SpriteComponent>(32, 32, 2, chopperRegion.texture,
+                                        chopperRegion.rect);
+  chopper.AddComponent<AnimationComponent>(chopperRight);
+
+  auto &particleSystem = registry->GetSystem<ParticleSystem>();
+
+  ParticleEffect dust;
+  dust.minLifetime = 0.4f;
+  dust.maxLifetime = 0.8f;
+  dust.maxSpeed = 15.0f;
+  dust.drag = 2.0f;
+  dust.startSize = 3.0f;
+  dust.endSize = 8.0f;
+  dust.startColor = {150, 120, 80, 160};
+  dust.endColor = {150, 120, 80, 0};
+  tank.AddComponent<ParticleEmitterComponent>(particleSystem.AddEffect(dust),
+                                              40.0f, 0, glm::vec2(16, 4));
+
+  ParticleEffect smoke;
+  smoke.minLifetime = 1.5f;
+  smoke.maxLifetime = 3.0f;
+  smoke.minSpeed = 10.0f;
+  smoke.maxSpeed = 25.0f;
+  smoke.direction = -90.0f;
+  smoke.spread = 40.0f;
+  smoke.startSize = 6.0f;
+  smoke.endSize = 20.0f;
+  smoke.startColor = {80, 80, 80, 200};
+  smoke.endColor = {40, 40, 40, 0};
+
+  ParticleEffect explosion;
+  explosion.minLifetime = 0.3f;
+  explosion.maxLifetime = 0.9f;
+  explosion.minSpeed = 40.0f;
+  explosion.maxSpeed = 160.0f;
+  explosion.drag = 3.0f;
+  explosion.startSize = 5.0f;
+  explosion.endSize = 2.0f;
+  explosion.startColor = {255, 200, 60, 255};
+  explosion.endColor = {200, 40, 0, 0};
+  explosion.blendMode = SDL_BLENDMODE_ADD;
+
+  const auto wreckRegion = atlas.GetRegion("truck-ford-killed");
+  Entity wreck = registry->CreateEntity();
+  wreck.AddComponent<TransformComponent>(glm::vec2(300.0, 200.0),
+                                         glm::vec2(1.0, 1.0), 0);
+  wreck.AddComponent<SpriteComponent>(32, 32, 1, wreckRegion.texture,
+                                      wreckRegion.rect);
+  wreck.AddComponent<ParticleEmitterComponent>(
+      particleSystem.AddEffect(smoke), 25.0f, 0, glm::vec2(16, 8));
+  particleSystem.Burst(particleSystem.AddEffect(explosion),
+                       glm::vec2(316.0, 216.0), 400);
 }
 
 void
 Game::Update() {
-  if (FPS_LIMIT > 0) {
+  if (FPS_LIMIT > 0 && !isHeadless) {
+    PROFILE_SCOPE("Game::Wait");
     int timeToWait =
         MILLISECS_PER_FRAME - (SDL_GetTicks() - millisecsPreviousFrame);
     if (timeToWait > 0 && timeToWait <= MILLISECS_PER_FRAME) {
@@ -48,34 +180,158 @@ Game::Update() {
     }
   }
 
-  double deltaTime = (SDL_GetTicks() - millisecsPreviousFrame) / 1000.0;
+  PROFILE_SCOPE("Game::Update");
 
   millisecsPreviousFrame = SDL_GetTicks();
 
-  registry->GetSystem<MovementSystem>().Update(deltaTime);
+  const Uint64 countCurrentFrame = SDL_GetPerformanceCounter();
+  const double frameTime = (countCurrentFrame - countPreviousFrame) /
+                           static_cast<double>(SDL_GetPerformanceFrequency());
+  countPreviousFrame = countCurrentFrame;
+
+  const double tickDuration = 1.0 / tickRate;
+  accumulator += frameTime;
+
+  int steps = 0;
+  while (accumulator >= tickDuration && steps < maxCatchUpSteps) {
+    FixedUpdate(tickDuration);
+    accumulator -= tickDuration;
+    steps++;
+  }
+
+  // After a spike, drop the time we could not catch up on instead of carrying
+  // it into the next frames.
+  if (accumulator >= tickDuration) {
+    accumulator = std::fmod(accumulator, tickDuration);
+  }
+
+  interpolationAlpha = accumulator / tickDuration;
+
+  Animate(frameTime);
+
+  if (assetWatcher) {
+    for (const auto &file : assetWatcher->Poll()) {
+      // Images packed into the atlas reload their region of the page.
+      const bool isAtlasImage = atlas.Reload(file);
+      const bool isTilemap =
+          registry->GetSystem<TilemapSystem>().Reload(file);
+      if (!assetStore->Reload(file) && !isAtlasImage && !isTilemap) {
+        spdlog::info("Changed file " + file + " is not a loaded asset");
+      }
+    }
+  }
+
+  assetStore->Update(renderer);
+}
+
+// Animations and particles are visual, so they follow the frame time rather
+// than the simulation tick.
+void
+Game::Animate(double deltaTime) {
+  registry->GetSystem<AnimationSystem>().Update(deltaTime);
+  registry->GetSystem<ParticleSystem>().Update(deltaTime);
+}
+
+void
+Game::FixedUpdate(double deltaTime) {
+  PROFILE_SCOPE("Game::FixedUpdate");
+  auto &movementSystem = registry->GetSystem<MovementSystem>();
+  auto &collisionSystem = registry->GetSystem<CollisionSystem>();
+
+  movementSystem.Update(deltaTime);
+
+  for (const auto &transition : movementSystem.GetSleepTransitions()) {
+    collisionSystem.SetSleeping(transition.entity, transition.isSleeping);
+  }
+  movementSystem.ClearSleepTransitions();
+
+  collisionSystem.Update();
+  movementSystem.UpdateSleep(collisionSystem.GetCollisions());
 
+  // Only bodies integrated this tick moved. Those that just fell asleep had
+  // their previous position reset, which shrinks their bounds once more.
+  auto &renderSystem = registry->GetSystem<RenderSystem>();
+  renderSystem.UpdateBounds(movementSystem.GetActiveEntities());
+  for (const auto &transition : movementSystem.GetSleepTransitions()) {
+    renderSystem.UpdateBounds(transition.entity);
+  }
+
+  registry->GetSystem<TilemapSystem>().Stream(
+      camera,
+      registry->GetSystem<PointOfInterestSystem>().GetSystemEntities());
+
+  // New sprites are indexed as they join the RenderSystem.
   registry->Update();
 }
 
 void
 Game::Render() {
-  SDL_SetRenderDrawColor(renderer, 21, 21, 21, 255);
-  SDL_RenderClear(renderer);
+  PROFILE_SCOPE("Game::Render");
+
+  // Headless, the systems still cull and batch against a null renderer.
+  if (renderer) {
+    SDL_SetRenderDrawColor(renderer, 21, 21, 21, 255);
+    SDL_RenderClear(renderer);
+  }
 
-  registry->GetSystem<RenderSystem>().Update(renderer);
+  auto &renderSystem = registry->GetSystem<RenderSystem>();
+  auto &particleSystem = registry->GetSystem<ParticleSystem>();
+  registry->GetSystem<TilemapSystem>().Update(renderer, camera, *assetStore);
+  renderSystem.Update(renderer, camera, *assetStore, interpolationAlpha);
+  particleSystem.Render(renderer, camera, *assetStore);
+
+  unsigned int drawCalls = renderSystem.GetSpriteBatch().GetDrawCallCount() +
+                           particleSystem.GetDrawCallCount();
+  if (debugOverlay) {
+    debugOverlay->Render(renderer, *registry, memoryTracker, windowWidth,
+                         windowHeight);
+    drawCalls += debugOverlay->GetDrawCallCount();
+  }
+  frameCount++;
+  drawCallCount += drawCalls;
+  PROFILE_COUNTER("Draw calls", drawCalls);
+  PROFILE_COUNTER("Entities", registry->GetEntityCount());
+  PROFILE_COUNTER("Particles", particleSystem.GetParticleCount());
+
+  if (renderer) {
+    PROFILE_SCOPE("SDL_RenderPresent");
+    SDL_RenderPresent(renderer);
+  }
+}
 
-  SDL_RenderPresent(renderer);
+// Samples the tracked containers once per frame, which also updates their
+// high-water marks.
+void
+Game::TrackMemory() {
+  registry->ReportMemory(memoryTracker);
+  assetStore->ReportMemory(memoryTracker);
+  PROFILE_COUNTER("Memory reserved", memoryTracker.GetReservedBytes());
+  PROFILE_COUNTER("Memory used", memoryTracker.GetUsedBytes());
 }
 
 Game::~Game() { spdlog::info("Game destractor called!"); }
 
 void
 Game::Initialize() {
+  if (isHeadless) {
+    InitializeHeadless();
+    return;
+  }
+
   if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
     spdlog::critical("Error initializing SDL.");
     return;
   }
 
+  if (TTF_Init() != 0) {
+    spdlog::critical("Error initializing SDL TTF.");
+    return;
+  }
+
+  if (Mix_OpenAudio(MIX_DEFAULT_FREQUENCY, MIX_DEFAULT_FORMAT, 2, 1024) != 0) {
+    spdlog::error("Error opening audio device, sounds will not load.");
+  }
+
   SDL_DisplayMode displayMode;
   SDL_GetCurrentDisplayMode(0, &displayMode);
   windowWidth = 800;    // displayMode.w;
@@ -98,6 +354,9 @@ Game::Initialize() {
     return;
   }
 
+  camera = Camera(glm::vec2(0, 0), 1.0f, {0, 0, windowWidth, windowHeight});
+  debugOverlay = std::make_unique<DebugOverlay>(renderer);
+
   if (FULLSCREEN == true) {
     SDL_SetWindowFullscreen(window, SDL_WINDOW_FULLSCREEN);
   }
@@ -105,20 +364,52 @@ Game::Initialize() {
   isRunning = true;
 }
 
+// Only timers and events are started, so no display or audio device is
+// needed; SDL still turns SIGINT and SIGTERM into SDL_QUIT.
+void
+Game::InitializeHeadless() {
+  if (SDL_Init(SDL_INIT_TIMER | SDL_INIT_EVENTS) != 0) {
+    spdlog::critical("Error initializing SDL.");
+    return;
+  }
+
+  if (TTF_Init() != 0) {
+    spdlog::critical("Error initializing SDL TTF.");
+    return;
+  }
+
+  windowWidth = 800;
+  windowHeight = 600;
+  camera = Camera(glm::vec2(0, 0), 1.0f, {0, 0, windowWidth, windowHeight});
+
+  spdlog::info("Running headless");
+  isRunning = true;
+}
+
 void
 Game::Run() {
   Setup();
+  flightRecorder = std::make_unique<FlightRecorder>(frameBudget);
+  millisecsPreviousFrame = SDL_GetTicks();
+  countPreviousFrame = SDL_GetPerformanceCounter();
   while (isRunning) {
     ProcessInput();
     Update();
     Render();
+    TrackMemory();
+    PROFILE_FRAME();
+    flightRecorder->Update();
   }
 }
 
 void
 Game::ProcessInput() {
+  PROFILE_SCOPE("Game::ProcessInput");
   SDL_Event sdlEvent;
   while (SDL_PollEvent(&sdlEvent)) {
+    if (debugOverlay) {
+      debugOverlay->ProcessEvent(sdlEvent);
+    }
     switch (sdlEvent.type) {
     case SDL_QUIT:
       isRunning = false;
@@ -127,6 +418,15 @@ Game::ProcessInput() {
       if (sdlEvent.key.keysym.sym == SDLK_ESCAPE) {
         isRunning = false;
       }
+      if (sdlEvent.key.keysym.sym == SDLK_F1 && debugOverlay) {
+        debugOverlay->isVisible = !debugOverlay->isVisible;
+      }
+      if (sdlEvent.key.keysym.sym == SDLK_F9) {
+        Profiler::WriteTrace("trace-" + std::to_string(frameCount) + ".json");
+      }
+      break;
+    case SDL_RENDER_TARGETS_RESET:
+      registry->GetSystem<TilemapSystem>().Invalidate();
       break;
     }
   }
@@ -134,7 +434,26 @@ Game::ProcessInput() {
 
 void
 Game::Destroy() {
-  SDL_DestroyRenderer(renderer);
-  SDL_DestroyWindow(window);
+  if (flightRecorder) {
+    flightRecorder->Flush();
+  }
+  if (!tracePath.empty()) {
+    Profiler::WriteTrace(tracePath);
+  }
+  assetWatcher.reset();
+  registry->GetSystem<TilemapSystem>().Clear();
+  atlas.Clear();
+  assetStore->Clear();
+  if (isHeadless) {
+    spdlog::info("Headless run drew " + std::to_string(frameCount) +
+                 " frames in " + std::to_string(drawCallCount) +
+                 " counted draw calls");
+  } else {
+    Mix_CloseAudio();
+    debugOverlay.reset();
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
+  }
+  TTF_Quit();
   SDL_Quit();
 }
\ No newline at end of file
@@ -1,37 +1,85 @@
 #ifndef GAME_H
 #define GAME_H
 
+#include "../AssetStore/AssetStore.h"
+#include "../AssetStore/AssetWatcher.h"
+#include "../Debug/DebugOverlay.h"
 #include "../ECS/ECS.h"
+#include "../Profiler/FlightRecorder.h"
+#include "../Profiler/MemoryTracker.h"
+#include "../Renderer/Camera.h"
+#include "../Renderer/TextureAtlas.h"
+#include "Benchmark.h"
 #include <SDL2/SDL.h>
 #include <memory>
+#include <string>
 
 const int FPS_LIMIT = 60; // 0 to unlimited
 const int MILLISECS_PER_FRAME = 1000 / FPS_LIMIT;
+const int TICK_RATE = 60; // simulation steps per second
+const int MAX_CATCHUP_STEPS = 5; // steps per frame before time is dropped
 const bool FULLSCREEN = false;
+const bool HOT_RELOAD = true; // reload changed assets/ files, never headless
+const double FRAME_BUDGET_TICKS = 2.0; // frames slower than this are traced
 
 class Game {
 private:
   bool isRunning;
   SDL_Window *window;
   SDL_Renderer *renderer;
+  Camera camera;
+  TextureAtlas atlas;
   int millisecsPreviousFrame = 0;
+  Uint64 countPreviousFrame = 0;
+  Uint64 frameCount = 0;
+  Uint64 drawCallCount = 0;
+  double accumulator = 0;
+  double interpolationAlpha = 0;
 
   std::unique_ptr<Registry> registry;
+  std::unique_ptr<AssetStore> assetStore;
+  std::unique_ptr<AssetWatcher> assetWatcher;
+  std::unique_ptr<FlightRecorder> flightRecorder;
+  std::unique_ptr<DebugOverlay> debugOverlay;
+  MemoryTracker memoryTracker;
 
 public:
   Game();
   ~Game();
 
   void Initialize();
+  void InitializeHeadless();
   void Run();
+  int RunBenchmark(const BenchmarkOptions &options);
   void ProcessInput();
   void Update();
+  void FixedUpdate(double deltaTime);
+  void Animate(double deltaTime);
   void Render();
+  void TrackMemory();
   void Destroy();
+  void SetupSystems();
   void Setup();
+  bool SetupBenchmark(const BenchmarkOptions &options);
+
+  const MemoryTracker &GetMemoryTracker() const { return memoryTracker; }
 
   int windowWidth;
   int windowHeight;
+  int tickRate = TICK_RATE;
+  int maxCatchUpSteps = MAX_CATCHUP_STEPS;
+
+  // Runs without a window or renderer, as fast as the loop allows; drawing
+  // is only counted. Set before Initialize.
+  bool isHeadless = false;
+
+  // Where the profiled frames are written as a Chrome trace on exit; empty
+  // writes nothing. F9 writes one at any time, and F1 shows the overlay.
+  std::string tracePath;
+
+  // Frames slower than this many milliseconds are written as spike traces;
+  // 0 never writes one. Set before Run.
+  double frameBudget = FRAME_BUDGET_TICKS * 1000 / TICK_RATE;
 };
 
 #endif
\ No newline at end of file
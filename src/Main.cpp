@@ -1,10 +1,89 @@
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+#include <string>
 #include "Game/Game.h"
 
+const char *USAGE =
+    "usage: game-engine [--headless] [--tick-rate HZ] [--trace trace.json]\n"
+    "                   [--frame-budget MS]\n"
+    "       game-engine --bench <sprites|collisions|particles> [--entities N]\n"
+    "                   [--frames N] [--seed N] [--output file.json]\n"
+    "                   [--tick-rate HZ]\n"
+    "                   [--trace trace.json] [--frame-budget MS]\n";
+
 int main(int argc, char* argv[]) {
+    bool isHeadless = false;
+    bool isBenchmark = false;
+    std::string tracePath;
+    double frameBudget = -1;
+    int tickRate = TICK_RATE;
+    BenchmarkOptions benchmark;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string argument = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (argument == "--headless") {
+            isHeadless = true;
+        } else if (argument == "--bench" && hasValue) {
+            isBenchmark = true;
+            benchmark.scenario = argv[++i];
+        } else if (argument == "--entities" && hasValue) {
+            benchmark.entityCount = std::strtoul(argv[++i], nullptr, 10);
+        } else if (argument == "--frames" && hasValue) {
+            benchmark.frameCount = std::strtoul(argv[++i], nullptr, 10);
+        } else if (argument == "--seed" && hasValue) {
+            benchmark.seed = std::strtoul(argv[++i], nullptr, 10);
+        } else if (argument == "--output" && hasValue) {
+            benchmark.outputPath = argv[++i];
+        } else if (argument == "--trace" && hasValue) {
+            tracePath = argv[++i];
+        } else if (argument == "--tick-rate" && hasValue) {
+            tickRate = std::atoi(argv[++i]);
+            if (tickRate <= 0) {
+                std::fputs(USAGE, stderr);
+                return 1;
+            }
+        } else if (argument == "--frame-budget" && hasValue) {
+            frameBudget = std::strtod(argv[++i], nullptr);
+            if (frameBudget < 0) {
+                std::fputs(USAGE, stderr);
+                return 1;
+            }
+        } else {
+            std::fputs(USAGE, stderr);
+            return 1;
+        }
+    }
+
+    // Unless a budget is given, frames over two ticks are traced. Benchmarks
+    // trace nothing by default, as writing spike files would skew them.
+    if (frameBudget < 0) {
+        frameBudget = isBenchmark ? 0 : FRAME_BUDGET_TICKS * 1000 / tickRate;
+    }
+
+    // The benchmark report may go to stdout, so logs go to stderr and only
+    // warnings get through.
+    if (isBenchmark) {
+        spdlog::set_default_logger(spdlog::stderr_color_mt("stderr"));
+        spdlog::set_level(spdlog::level::warn);
+    }
+
     Game game;
+    game.isHeadless = isHeadless || isBenchmark;
+    game.tracePath = tracePath;
+    game.frameBudget = frameBudget;
+    game.tickRate = tickRate;
 
     game.Initialize();
+    if (isBenchmark) {
+        const int exitCode = game.RunBenchmark(benchmark);
+        game.Destroy();
+        return exitCode;
+    }
+
     game.Run();
     game.Destroy();
 
@@ -0,0 +1,231 @@
+#include "ParticlePool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Bit offsets of r, g, b and a inside a packed color, so that its bytes are
+// laid out like an SDL_Color.
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+const int COLOR_SHIFTS[4] = {0, 8, 16, 24};
+#else
+const int COLOR_SHIFTS[4] = {24, 16, 8, 0};
+#endif
+
+static uint32_t
+PackColor(SDL_Color color) {
+  uint32_t packed;
+  std::memcpy(&packed, &color, sizeof(packed));
+  return packed;
+}
+
+ParticlePool::ParticlePool(const ParticleEffect &effect,
+                           unsigned int capacity) {
+  this->effect = effect;
+  this->capacity = capacity;
+
+  const unsigned int padded = (capacity + 3) & ~3u;
+  positionX.resize(padded);
+  positionY.resize(padded);
+  velocityX.resize(padded);
+  velocityY.resize(padded);
+  life.resize(padded);
+  inverseLifetime.resize(padded);
+  sizes.resize(padded);
+  colors.resize(padded);
+}
+
+unsigned int
+ParticlePool::Emit(glm::vec2 position, glm::vec2 velocity,
+                   unsigned int count) {
+  count = std::min(count, capacity - this->count);
+
+  const uint32_t startColor = PackColor(effect.startColor);
+  for (unsigned int i = this->count; i < this->count + count; i++) {
+    const float angle = glm::radians(effect.direction +
+                                     (Random() - 0.5f) * effect.spread);
+    const float speed =
+        effect.minSpeed + (effect.maxSpeed - effect.minSpeed) * Random();
+    const float lifetime = effect.minLifetime +
+                           (effect.maxLifetime - effect.minLifetime) * Random();
+
+    positionX[i] = position.x;
+    positionY[i] = position.y;
+    velocityX[i] = velocity.x + std::cos(angle) * speed;
+    velocityY[i] = velocity.y + std::sin(angle) * speed;
+    life[i] = lifetime;
+    inverseLifetime[i] = lifetime > 0.0f ? 1.0f / lifetime : 0.0f;
+    sizes[i] = effect.startSize;
+    colors[i] = startColor;
+  }
+
+  this->count += count;
+  return count;
+}
+
+void
+ParticlePool::Update(float deltaTime) {
+  if (count == 0) {
+    return;
+  }
+
+  const float damping = std::max(0.0f, 1.0f - effect.drag * deltaTime);
+  const float accelerationX = effect.acceleration.x * deltaTime;
+  const float accelerationY = effect.acceleration.y * deltaTime;
+  const float sizeDelta = effect.endSize - effect.startSize;
+
+  const float startChannels[4] = {
+      static_cast<float>(effect.startColor.r),
+      static_cast<float>(effect.startColor.g),
+      static_cast<float>(effect.startColor.b),
+      static_cast<float>(effect.startColor.a)};
+  const float channelDeltas[4] = {
+      effect.endColor.r - startChannels[0],
+      effect.endColor.g - startChannels[1],
+      effect.endColor.b - startChannels[2],
+      effect.endColor.a - startChannels[3]};
+
+  unsigned int i = 0;
+  bool hasDead = false;
+
+#ifdef __SSE2__
+  const __m128 deltaTime4 = _mm_set1_ps(deltaTime);
+  const __m128 damping4 = _mm_set1_ps(damping);
+  const __m128 accelerationX4 = _mm_set1_ps(accelerationX);
+  const __m128 accelerationY4 = _mm_set1_ps(accelerationY);
+  const __m128 one4 = _mm_set1_ps(1.0f);
+  const __m128 startSize4 = _mm_set1_ps(effect.startSize);
+  const __m128 sizeDelta4 = _mm_set1_ps(sizeDelta);
+  const __m128 zero4 = _mm_setzero_ps();
+
+  // The arrays are padded, so the last step may read and write up to three
+  // unused slots.
+  for (; i < count; i += 4) {
+    __m128 vx = _mm_loadu_ps(&velocityX[i]);
+    __m128 vy = _mm_loadu_ps(&velocityY[i]);
+    vx = _mm_add_ps(_mm_mul_ps(vx, damping4), accelerationX4);
+    vy = _mm_add_ps(_mm_mul_ps(vy, damping4), accelerationY4);
+    _mm_storeu_ps(&velocityX[i], vx);
+    _mm_storeu_ps(&velocityY[i], vy);
+
+    _mm_storeu_ps(&positionX[i], _mm_add_ps(_mm_loadu_ps(&positionX[i]),
+                                            _mm_mul_ps(vx, deltaTime4)));
+    _mm_storeu_ps(&positionY[i], _mm_add_ps(_mm_loadu_ps(&positionY[i]),
+                                            _mm_mul_ps(vy, deltaTime4)));
+
+    const __m128 left = _mm_sub_ps(_mm_loadu_ps(&life[i]), deltaTime4);
+    _mm_storeu_ps(&life[i], left);
+    const int lanes = count - i < 4 ? (1 << (count - i)) - 1 : 0xF;
+    hasDead |= (_mm_movemask_ps(_mm_cmple_ps(left, zero4)) & lanes) != 0;
+
+    // Share of the lifetime already spent, from 0 to 1.
+    const __m128 spent = _mm_mul_ps(left, _mm_loadu_ps(&inverseLifetime[i]));
+    const __m128 age = _mm_min_ps(one4, _mm_sub_ps(one4, spent));
+    _mm_storeu_ps(&sizes[i],
+                  _mm_add_ps(startSize4, _mm_mul_ps(sizeDelta4, age)));
+
+    __m128i packed = _mm_setzero_si128();
+    for (int channel = 0; channel < 4; channel++) {
+      const __m128 value =
+          _mm_add_ps(_mm_set1_ps(startChannels[channel]),
+                     _mm_mul_ps(_mm_set1_ps(channelDeltas[channel]), age));
+      packed = _mm_or_si128(
+          packed, _mm_sll_epi32(_mm_cvttps_epi32(value),
+                                _mm_cvtsi32_si128(COLOR_SHIFTS[channel])));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(&colors[i]), packed);
+  }
+#endif
+
+  for (; i < count; i++) {
+    velocityX[i] = velocityX[i] * damping + accelerationX;
+    velocityY[i] = velocityY[i] * damping + accelerationY;
+    positionX[i] += velocityX[i] * deltaTime;
+    positionY[i] += velocityY[i] * deltaTime;
+    life[i] -= deltaTime;
+    hasDead |= life[i] <= 0.0f;
+
+    const float age = std::min(1.0f, 1.0f - life[i] * inverseLifetime[i]);
+    sizes[i] = effect.startSize + sizeDelta * age;
+
+    uint32_t packed = 0;
+    for (int channel = 0; channel < 4; channel++) {
+      const auto value = static_cast<uint32_t>(startChannels[channel] +
+                                               channelDeltas[channel] * age);
+      packed |= value << COLOR_SHIFTS[channel];
+    }
+    colors[i] = packed;
+  }
+
+  if (hasDead) {
+    RemoveDead();
+  }
+}
+
+void
+ParticlePool::RemoveDead() {
+  unsigned int i = 0;
+  while (i < count) {
+    if (life[i] > 0.0f) {
+      i++;
+      continue;
+    }
+
+    // The moved particle is checked on the next pass through this slot.
+    const unsigned int last = --count;
+    positionX[i] = positionX[last];
+    positionY[i] = positionY[last];
+    velocityX[i] = velocityX[last];
+    velocityY[i] = velocityY[last];
+    life[i] = life[last];
+    inverseLifetime[i] = inverseLifetime[last];
+    sizes[i] = sizes[last];
+    colors[i] = colors[last];
+  }
+}
+
+unsigned int
+ParticlePool::WriteVertices(unsigned int first, unsigned int count,
+                            const Camera &camera, float *xy,
+                            SDL_Color *color) const {
+  const AABB view = camera.GetWorldBounds();
+  const float zoom = camera.zoom;
+  const float offsetX = camera.viewport.x - camera.position.x * zoom;
+  const float offsetY = camera.viewport.y - camera.position.y * zoom;
+
+  const unsigned int end = std::min(first + count, this->count);
+  unsigned int written = 0;
+  for (unsigned int i = first; i < end; i++) {
+    const float half = sizes[i] * 0.5f;
+    if (positionX[i] + half < view.min.x || positionX[i] - half > view.max.x ||
+        positionY[i] + half < view.min.y || positionY[i] - half > view.max.y) {
+      continue;
+    }
+
+    const float left = (positionX[i] - half) * zoom + offsetX;
+    const float top = (positionY[i] - half) * zoom + offsetY;
+    const float right = (positionX[i] + half) * zoom + offsetX;
+    const float bottom = (positionY[i] + half) * zoom + offsetY;
+
+    float *quad = xy + written * 8;
+    quad[0] = left;
+    quad[1] = top;
+    quad[2] = right;
+    quad[3] = top;
+    quad[4] = right;
+    quad[5] = bottom;
+    quad[6] = left;
+    quad[7] = bottom;
+
+    SDL_Color particleColor;
+    std::memcpy(&particleColor, &colors[i], sizeof(particleColor));
+    std::fill_n(color + written * 4, 4, particleColor);
+
+    written++;
+  }
+
+  return written;
+}
@@ -0,0 +1,85 @@
+#ifndef PARTICLEPOOL_H
+#define PARTICLEPOOL_H
+
+#include "../AssetStore/AssetHandle.h"
+#include "../Renderer/Camera.h"
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+// How one kind of particle is born, moves and fades. Size and color go from
+// their start to their end value over a particle's lifetime. Without a
+// texture particles are drawn as colored squares.
+struct ParticleEffect {
+  AssetHandle texture;
+  SDL_Rect srcRect = {0, 0, 0, 0};
+  SDL_BlendMode blendMode = SDL_BLENDMODE_BLEND;
+  float minLifetime = 1.0f; // seconds
+  float maxLifetime = 1.0f;
+  float minSpeed = 0.0f; // pixels per second
+  float maxSpeed = 0.0f;
+  float direction = 0.0f; // degrees, 0 points right and 90 down
+  float spread = 360.0f;  // degrees around the direction
+  glm::vec2 acceleration = glm::vec2(0, 0);
+  float drag = 0.0f; // share of the velocity lost per second
+  float startSize = 4.0f;
+  float endSize = 4.0f;
+  SDL_Color startColor = {255, 255, 255, 255};
+  SDL_Color endColor = {255, 255, 255, 0};
+};
+
+// The live particles of one effect, as parallel arrays. Update integrates
+// four particles per step with SSE2 where available and removes dead ones by
+// moving the last particle into their slot, so the live ones stay packed at
+// the front and are drawn in one contiguous sweep.
+class ParticlePool {
+private:
+  ParticleEffect effect;
+  unsigned int capacity;
+  unsigned int count = 0;
+
+  // Padded to a multiple of four so the last step can run past count.
+  std::vector<float> positionX;
+  std::vector<float> positionY;
+  std::vector<float> velocityX;
+  std::vector<float> velocityY;
+  std::vector<float> life; // seconds left
+  std::vector<float> inverseLifetime;
+  std::vector<float> sizes;
+  std::vector<uint32_t> colors; // SDL_Color bytes
+
+  uint32_t seed = 0x9E3779B9;
+
+  float Random() {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return (seed >> 8) * (1.0f / 16777216.0f);
+  }
+
+  void RemoveDead();
+
+public:
+  ParticlePool(const ParticleEffect &effect, unsigned int capacity);
+  ~ParticlePool() = default;
+
+  // Returns how many fit; the rest are dropped.
+  unsigned int Emit(glm::vec2 position, glm::vec2 velocity,
+                    unsigned int count);
+  void Update(float deltaTime);
+  void Clear() { count = 0; }
+
+  // Four vertices per particle in [first, first + count), clockwise from the
+  // top-left: eight floats of screen position and four colors each. Particles
+  // outside the camera are skipped; returns how many were written.
+  unsigned int WriteVertices(unsigned int first, unsigned int count,
+                             const Camera &camera, float *xy,
+                             SDL_Color *color) const;
+
+  const ParticleEffect &GetEffect() const { return effect; }
+  unsigned int GetCount() const { return count; }
+  unsigned int GetCapacity() const { return capacity; }
+};
+
+#endif
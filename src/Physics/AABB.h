@@ -0,0 +1,82 @@
+#ifndef AABB_H
+#define AABB_H
+
+#include <algorithm>
+#include <glm/glm.hpp>
+
+struct AABB {
+  glm::vec2 min;
+  glm::vec2 max;
+
+  AABB(glm::vec2 min = glm::vec2(0, 0), glm::vec2 max = glm::vec2(0, 0)) {
+    this->min = min;
+    this->max = max;
+  }
+
+  bool Overlaps(const AABB &other) const {
+    return min.x < other.max.x && other.min.x < max.x && min.y < other.max.y &&
+           other.min.y < max.y;
+  }
+
+  bool Contains(const AABB &other) const {
+    return min.x <= other.min.x && min.y <= other.min.y &&
+           other.max.x <= max.x && other.max.y <= max.y;
+  }
+
+  float Perimeter() const { return 2.0f * ((max.x - min.x) + (max.y - min.y)); }
+
+  AABB Fattened(float margin) const {
+    return AABB(min - glm::vec2(margin, margin), max + glm::vec2(margin, margin));
+  }
+
+  static AABB Union(const AABB &a, const AABB &b) {
+    return AABB(glm::min(a.min, b.min), glm::max(a.max, b.max));
+  }
+
+  // Slab test of the segment from + t * (to - from), t in [0, 1]. On a hit
+  // fraction is the entry t, or 0 when the segment starts inside the box.
+  bool Raycast(const glm::vec2 &from, const glm::vec2 &to,
+               float &fraction) const {
+    const glm::vec2 delta = to - from;
+    float tMin = 0.0f;
+    float tMax = 1.0f;
+
+    for (int axis = 0; axis < 2; axis++) {
+      if (delta[axis] == 0.0f) {
+        if (from[axis] < min[axis] || from[axis] > max[axis]) {
+          return false;
+        }
+        continue;
+      }
+
+      const float inverse = 1.0f / delta[axis];
+      float t1 = (min[axis] - from[axis]) * inverse;
+      float t2 = (max[axis] - from[axis]) * inverse;
+      if (t1 > t2) {
+        std::swap(t1, t2);
+      }
+
+      tMin = std::max(tMin, t1);
+      tMax = std::min(tMax, t2);
+      if (tMin > tMax) {
+        return false;
+      }
+    }
+
+    fraction = tMin;
+    return true;
+  }
+
+  // Time of impact of two boxes translating linearly over one step, as a
+  // fraction of the step. Works in a's frame: a's min corner travels along
+  // the relative displacement into b grown by a's size.
+  static bool Sweep(const AABB &a, const glm::vec2 &displacementA,
+                    const AABB &b, const glm::vec2 &displacementB,
+                    float &timeOfImpact) {
+    const AABB expanded(b.min - (a.max - a.min), b.max);
+    const glm::vec2 relative = displacementA - displacementB;
+    return expanded.Raycast(a.min, a.min + relative, timeOfImpact);
+  }
+};
+
+#endif
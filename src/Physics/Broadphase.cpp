@@ -0,0 +1,17 @@
+#include "Broadphase.h"
+#include "DynamicAABBTree.h"
+#include "SpatialHashGrid.h"
+#include "SweepAndPrune.h"
+
+std::unique_ptr<IBroadphase>
+CreateBroadphase(BroadphaseType type) {
+  switch (type) {
+  case BroadphaseType::DynamicAABBTree:
+    return std::make_unique<DynamicAABBTree>();
+  case BroadphaseType::SweepAndPrune:
+    return std::make_unique<SweepAndPrune>();
+  case BroadphaseType::SpatialHashGrid:
+  default:
+    return std::make_unique<SpatialHashGrid>();
+  }
+}
@@ -0,0 +1,34 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include "AABB.h"
+#include <memory>
+#include <vector>
+
+const unsigned int INVALID_PROXY = ~0u;
+
+struct BroadphasePair {
+  unsigned int a;
+  unsigned int b;
+};
+
+// Candidate pairs are conservative: a backend may report pairs whose boxes do
+// not overlap, but never misses one that does. Each pair is reported once with
+// a < b.
+class IBroadphase {
+public:
+  virtual ~IBroadphase() {}
+
+  virtual void Insert(unsigned int id, const AABB &box) = 0;
+  virtual void Remove(unsigned int id) = 0;
+  virtual void Move(unsigned int id, const AABB &box) = 0;
+
+  virtual void ComputePairs(std::vector<BroadphasePair> &pairs) = 0;
+  virtual void Query(const AABB &box, std::vector<unsigned int> &result) = 0;
+};
+
+enum class BroadphaseType { SpatialHashGrid, DynamicAABBTree, SweepAndPrune };
+
+std::unique_ptr<IBroadphase> CreateBroadphase(BroadphaseType type);
+
+#endif
@@ -0,0 +1,410 @@
+#include "DynamicAABBTree.h"
+#include <algorithm>
+
+DynamicAABBTree::DynamicAABBTree(float margin) { this->margin = margin; }
+
+unsigned int
+DynamicAABBTree::AllocateNode() {
+  unsigned int node;
+  if (freeList != INVALID_PROXY) {
+    node = freeList;
+    freeList = nodes[node].parent;
+  } else {
+    node = nodes.size();
+    nodes.emplace_back();
+  }
+
+  nodes[node].parent = INVALID_PROXY;
+  nodes[node].child1 = INVALID_PROXY;
+  nodes[node].child2 = INVALID_PROXY;
+  nodes[node].height = 0;
+  nodes[node].id = INVALID_PROXY;
+  return node;
+}
+
+void
+DynamicAABBTree::FreeNode(unsigned int node) {
+  nodes[node].parent = freeList;
+  nodes[node].height = -1;
+  freeList = node;
+}
+
+void
+DynamicAABBTree::Insert(unsigned int id, const AABB &box) {
+  if (id >= leafOfId.size()) {
+    leafOfId.resize(id + 1, INVALID_PROXY);
+    tightBoxes.resize(id + 1);
+  }
+
+  if (leafOfId[id] != INVALID_PROXY) {
+    Move(id, box);
+    return;
+  }
+
+  const auto leaf = AllocateNode();
+  nodes[leaf].box = box.Fattened(margin);
+  nodes[leaf].id = id;
+  leafOfId[id] = leaf;
+  tightBoxes[id] = box;
+
+  InsertLeaf(leaf);
+}
+
+void
+DynamicAABBTree::Remove(unsigned int id) {
+  if (id >= leafOfId.size() || leafOfId[id] == INVALID_PROXY) {
+    return;
+  }
+
+  const auto leaf = leafOfId[id];
+  RemoveLeaf(leaf);
+  FreeNode(leaf);
+  leafOfId[id] = INVALID_PROXY;
+}
+
+void
+DynamicAABBTree::Move(unsigned int id, const AABB &box) {
+  const auto leaf = leafOfId[id];
+  const glm::vec2 displacement = box.min - tightBoxes[id].min;
+  tightBoxes[id] = box;
+
+  if (nodes[leaf].box.Contains(box)) {
+    return;
+  }
+
+  // Stretch the fat box along the motion so steadily moving proxies are not
+  // reinserted every few frames.
+  AABB fatBox = box.Fattened(margin);
+  const glm::vec2 prediction = displacement * DISPLACEMENT_MULTIPLIER;
+  fatBox.min += glm::min(prediction, glm::vec2(0, 0));
+  fatBox.max += glm::max(prediction, glm::vec2(0, 0));
+
+  RemoveLeaf(leaf);
+  nodes[leaf].box = fatBox;
+  InsertLeaf(leaf);
+}
+
+void
+DynamicAABBTree::InsertLeaf(unsigned int leaf) {
+  if (root == INVALID_PROXY) {
+    root = leaf;
+    nodes[root].parent = INVALID_PROXY;
+    return;
+  }
+
+  // Descend towards the sibling with the lowest surface area heuristic cost,
+  // counting the growth every ancestor would inherit.
+  const AABB leafBox = nodes[leaf].box;
+  unsigned int index = root;
+  while (!nodes[index].IsLeaf()) {
+    const auto &node = nodes[index];
+    const float area = node.box.Perimeter();
+    const float combinedArea = AABB::Union(node.box, leafBox).Perimeter();
+
+    const float cost = 2.0f * combinedArea;
+    const float inheritanceCost = 2.0f * (combinedArea - area);
+
+    float childCosts[2];
+    const unsigned int children[2] = {node.child1, node.child2};
+    for (int i = 0; i < 2; i++) {
+      const auto &child = nodes[children[i]];
+      const float unionArea = AABB::Union(leafBox, child.box).Perimeter();
+      childCosts[i] = child.IsLeaf()
+                          ? unionArea + inheritanceCost
+                          : unionArea - child.box.Perimeter() + inheritanceCost;
+    }
+
+    if (cost < childCosts[0] && cost < childCosts[1]) {
+      break;
+    }
+
+    index = childCosts[0] < childCosts[1] ? children[0] : children[1];
+  }
+
+  const auto sibling = index;
+  const auto oldParent = nodes[sibling].parent;
+  const auto newParent = AllocateNode();
+
+  nodes[newParent].parent = oldParent;
+  nodes[newParent].box = AABB::Union(leafBox, nodes[sibling].box);
+  nodes[newParent].height = nodes[sibling].height + 1;
+  nodes[newParent].child1 = sibling;
+  nodes[newParent].child2 = leaf;
+
+  if (oldParent != INVALID_PROXY) {
+    if (nodes[oldParent].child1 == sibling) {
+      nodes[oldParent].child1 = newParent;
+    } else {
+      nodes[oldParent].child2 = newParent;
+    }
+  } else {
+    root = newParent;
+  }
+
+  nodes[sibling].parent = newParent;
+  nodes[leaf].parent = newParent;
+
+  RefitAncestors(newParent);
+}
+
+void
+DynamicAABBTree::RemoveLeaf(unsigned int leaf) {
+  if (leaf == root) {
+    root = INVALID_PROXY;
+    return;
+  }
+
+  const auto parent = nodes[leaf].parent;
+  const auto grandParent = nodes[parent].parent;
+  const auto sibling = nodes[parent].child1 == leaf ? nodes[parent].child2
+                                                    : nodes[parent].child1;
+
+  if (grandParent != INVALID_PROXY) {
+    if (nodes[grandParent].child1 == parent) {
+      nodes[grandParent].child1 = sibling;
+    } else {
+      nodes[grandParent].child2 = sibling;
+    }
+    nodes[sibling].parent = grandParent;
+    FreeNode(parent);
+
+    RefitAncestors(grandParent);
+  } else {
+    root = sibling;
+    nodes[sibling].parent = INVALID_PROXY;
+    FreeNode(parent);
+  }
+}
+
+void
+DynamicAABBTree::RefitAncestors(unsigned int node) {
+  while (node != INVALID_PROXY) {
+    node = Balance(node);
+
+    auto &current = nodes[node];
+    const auto &child1 = nodes[current.child1];
+    const auto &child2 = nodes[current.child2];
+
+    current.height = 1 + std::max(child1.height, child2.height);
+    current.box = AABB::Union(child1.box, child2.box);
+
+    node = current.parent;
+  }
+}
+
+unsigned int
+DynamicAABBTree::Balance(unsigned int iA) {
+  auto &a = nodes[iA];
+  if (a.IsLeaf() || a.height < 2) {
+    return iA;
+  }
+
+  const auto iB = a.child1;
+  const auto iC = a.child2;
+  auto &b = nodes[iB];
+  auto &c = nodes[iC];
+
+  const int balance = c.height - b.height;
+
+  // Rotate C up: A takes the shorter of C's children, C takes A's place.
+  if (balance > 1) {
+    const auto iF = c.child1;
+    const auto iG = c.child2;
+    auto &f = nodes[iF];
+    auto &g = nodes[iG];
+
+    c.child1 = iA;
+    c.parent = a.parent;
+    a.parent = iC;
+
+    if (c.parent != INVALID_PROXY) {
+      if (nodes[c.parent].child1 == iA) {
+        nodes[c.parent].child1 = iC;
+      } else {
+        nodes[c.parent].child2 = iC;
+      }
+    } else {
+      root = iC;
+    }
+
+    if (f.height > g.height) {
+      c.child2 = iF;
+      a.child2 = iG;
+      g.parent = iA;
+      a.box = AABB::Union(b.box, g.box);
+      c.box = AABB::Union(a.box, f.box);
+      a.height = 1 + std::max(b.height, g.height);
+      c.height = 1 + std::max(a.height, f.height);
+    } else {
+      c.child2 = iG;
+      a.child2 = iF;
+      f.parent = iA;
+      a.box = AABB::Union(b.box, f.box);
+      c.box = AABB::Union(a.box, g.box);
+      a.height = 1 + std::max(b.height, f.height);
+      c.height = 1 + std::max(a.height, g.height);
+    }
+
+    return iC;
+  }
+
+  // Rotate B up, mirroring the case above.
+  if (balance < -1) {
+    const auto iD = b.child1;
+    const auto iE = b.child2;
+    auto &d = nodes[iD];
+    auto &e = nodes[iE];
+
+    b.child1 = iA;
+    b.parent = a.parent;
+    a.parent = iB;
+
+    if (b.parent != INVALID_PROXY) {
+      if (nodes[b.parent].child1 == iA) {
+        nodes[b.parent].child1 = iB;
+      } else {
+        nodes[b.parent].child2 = iB;
+      }
+    } else {
+      root = iB;
+    }
+
+    if (d.height > e.height) {
+      b.child2 = iD;
+      a.child1 = iE;
+      e.parent = iA;
+      a.box = AABB::Union(c.box, e.box);
+      b.box = AABB::Union(a.box, d.box);
+      a.height = 1 + std::max(c.height, e.height);
+      b.height = 1 + std::max(a.height, d.height);
+    } else {
+      b.child2 = iE;
+      a.child1 = iD;
+      d.parent = iA;
+      a.box = AABB::Union(c.box, d.box);
+      b.box = AABB::Union(a.box, e.box);
+      a.height = 1 + std::max(c.height, d.height);
+      b.height = 1 + std::max(a.height, e.height);
+    }
+
+    return iB;
+  }
+
+  return iA;
+}
+
+void
+DynamicAABBTree::ComputePairs(std::vector<BroadphasePair> &pairs) {
+  if (root == INVALID_PROXY) {
+    return;
+  }
+
+  // Collide the tree with itself: a subtree paired with itself splits into
+  // its two children and their cross pair, and two distinct subtrees descend
+  // into the larger one only while their boxes overlap. Every leaf pair is
+  // therefore visited once.
+  pairStack.clear();
+  pairStack.push_back({root, root});
+  while (!pairStack.empty()) {
+    const auto current = pairStack.back();
+    pairStack.pop_back();
+
+    const auto &a = nodes[current.a];
+    const auto &b = nodes[current.b];
+
+    if (current.a == current.b) {
+      if (!a.IsLeaf()) {
+        pairStack.push_back({a.child1, a.child1});
+        pairStack.push_back({a.child2, a.child2});
+        pairStack.push_back({a.child1, a.child2});
+      }
+      continue;
+    }
+
+    if (!a.box.Overlaps(b.box)) {
+      continue;
+    }
+
+    if (a.IsLeaf() && b.IsLeaf()) {
+      if (tightBoxes[a.id].Overlaps(tightBoxes[b.id])) {
+        pairs.push_back({std::min(a.id, b.id), std::max(a.id, b.id)});
+      }
+    } else if (a.IsLeaf() ||
+               (!b.IsLeaf() && b.box.Perimeter() > a.box.Perimeter())) {
+      pairStack.push_back({current.a, b.child1});
+      pairStack.push_back({current.a, b.child2});
+    } else {
+      pairStack.push_back({a.child1, current.b});
+      pairStack.push_back({a.child2, current.b});
+    }
+  }
+}
+
+void
+DynamicAABBTree::Query(const AABB &box, std::vector<unsigned int> &result) {
+  if (root == INVALID_PROXY) {
+    return;
+  }
+
+  stack.clear();
+  stack.push_back(root);
+  while (!stack.empty()) {
+    const auto &node = nodes[stack.back()];
+    stack.pop_back();
+
+    if (!node.box.Overlaps(box)) {
+      continue;
+    }
+
+    if (node.IsLeaf()) {
+      if (tightBoxes[node.id].Overlaps(box)) {
+        result.push_back(node.id);
+      }
+    } else {
+      stack.push_back(node.child1);
+      stack.push_back(node.child2);
+    }
+  }
+}
+
+bool
+DynamicAABBTree::Raycast(const glm::vec2 &from, const glm::vec2 &to,
+                         RaycastHit &hit) {
+  hit.id = INVALID_PROXY;
+  hit.fraction = 1.0f;
+
+  if (root == INVALID_PROXY) {
+    return false;
+  }
+
+  stack.clear();
+  stack.push_back(root);
+  while (!stack.empty()) {
+    const auto &node = nodes[stack.back()];
+    stack.pop_back();
+
+    float fraction;
+    if (!node.box.Raycast(from, to, fraction) || fraction > hit.fraction) {
+      continue;
+    }
+
+    if (node.IsLeaf()) {
+      if (tightBoxes[node.id].Raycast(from, to, fraction) &&
+          fraction <= hit.fraction) {
+        hit.id = node.id;
+        hit.fraction = fraction;
+      }
+    } else {
+      stack.push_back(node.child1);
+      stack.push_back(node.child2);
+    }
+  }
+
+  hit.point = from + (to - from) * hit.fraction;
+  return hit.id != INVALID_PROXY;
+}
+
+int
+DynamicAABBTree::GetHeight() const {
+  return root == INVALID_PROXY ? 0 : nodes[root].height;
+}
@@ -0,0 +1,65 @@
+#ifndef DYNAMICAABBTREE_H
+#define DYNAMICAABBTREE_H
+
+#include "Broadphase.h"
+#include <vector>
+
+const float DISPLACEMENT_MULTIPLIER = 4.0f;
+
+struct RaycastHit {
+  unsigned int id;
+  float fraction;
+  glm::vec2 point;
+};
+
+// Bounding volume hierarchy over fattened boxes. Moves that stay inside a
+// leaf's fat box cost nothing; others reinsert the leaf, and every insert or
+// removal rebalances its ancestors with rotations.
+class DynamicAABBTree : public IBroadphase {
+private:
+  struct Node {
+    AABB box;
+    unsigned int parent;
+    unsigned int child1;
+    unsigned int child2;
+    int height;
+    unsigned int id;
+
+    bool IsLeaf() const { return child1 == INVALID_PROXY; }
+  };
+
+  float margin;
+  unsigned int root = INVALID_PROXY;
+  unsigned int freeList = INVALID_PROXY;
+
+  // Free nodes are chained through their parent field.
+  std::vector<Node> nodes;
+  std::vector<unsigned int> leafOfId;
+  std::vector<AABB> tightBoxes;
+  std::vector<unsigned int> stack;
+  std::vector<BroadphasePair> pairStack;
+
+  unsigned int AllocateNode();
+  void FreeNode(unsigned int node);
+  void InsertLeaf(unsigned int leaf);
+  void RemoveLeaf(unsigned int leaf);
+  unsigned int Balance(unsigned int node);
+  void RefitAncestors(unsigned int node);
+
+public:
+  DynamicAABBTree(float margin = 8.0f);
+  virtual ~DynamicAABBTree() = default;
+
+  void Insert(unsigned int id, const AABB &box) override;
+  void Remove(unsigned int id) override;
+  void Move(unsigned int id, const AABB &box) override;
+
+  void ComputePairs(std::vector<BroadphasePair> &pairs) override;
+  void Query(const AABB &box, std::vector<unsigned int> &result) override;
+
+  bool Raycast(const glm::vec2 &from, const glm::vec2 &to, RaycastHit &hit);
+
+  int GetHeight() const;
+};
+
+#endif
@@ -0,0 +1,177 @@
+#include "SpatialHashGrid.h"
+#include <algorithm>
+#include <cmath>
+
+SpatialHashGrid::SpatialHashGrid(float cellSize) {
+  this->cellSize = cellSize;
+  this->inverseCellSize = 1.0f / cellSize;
+}
+
+int
+SpatialHashGrid::CellCoord(float value) const {
+  return static_cast<int>(std::floor(value * inverseCellSize));
+}
+
+unsigned int
+SpatialHashGrid::Bucket(int x, int y) const {
+  const unsigned int hash = static_cast<unsigned int>(x) * 73856093u ^
+                            static_cast<unsigned int>(y) * 19349663u;
+  return hash & bucketMask;
+}
+
+void
+SpatialHashGrid::Insert(unsigned int id, const AABB &box) {
+  if (id >= proxyOfId.size()) {
+    proxyOfId.resize(id + 1, INVALID_PROXY);
+  }
+
+  if (proxyOfId[id] != INVALID_PROXY) {
+    Move(id, box);
+    return;
+  }
+
+  proxyOfId[id] = ids.size();
+  ids.push_back(id);
+  boxes.push_back(box);
+  isDirty = true;
+}
+
+void
+SpatialHashGrid::Remove(unsigned int id) {
+  if (id >= proxyOfId.size() || proxyOfId[id] == INVALID_PROXY) {
+    return;
+  }
+
+  const auto proxy = proxyOfId[id];
+  const auto last = ids.size() - 1;
+
+  ids[proxy] = ids[last];
+  boxes[proxy] = boxes[last];
+  proxyOfId[ids[proxy]] = proxy;
+  proxyOfId[id] = INVALID_PROXY;
+
+  ids.pop_back();
+  boxes.pop_back();
+  isDirty = true;
+}
+
+void
+SpatialHashGrid::Move(unsigned int id, const AABB &box) {
+  boxes[proxyOfId[id]] = box;
+  isDirty = true;
+}
+
+void
+SpatialHashGrid::Rebuild() {
+  scratch.clear();
+  for (unsigned int proxy = 0; proxy < boxes.size(); proxy++) {
+    const auto &box = boxes[proxy];
+    const int x0 = CellCoord(box.min.x);
+    const int y0 = CellCoord(box.min.y);
+    const int x1 = CellCoord(box.max.x);
+    const int y1 = CellCoord(box.max.y);
+
+    for (int y = y0; y <= y1; y++) {
+      for (int x = x0; x <= x1; x++) {
+        scratch.push_back({x, y, proxy});
+      }
+    }
+  }
+
+  unsigned int bucketCount = 1024;
+  while (bucketCount < scratch.size() * 2) {
+    bucketCount <<= 1;
+  }
+
+  bucketMask = bucketCount - 1;
+
+  // Count into each bucket, turn counts into bucket ends, then fill backwards
+  // so every end is walked down to its bucket's start.
+  bucketStarts.assign(bucketCount + 1, 0);
+  for (const auto &entry : scratch) {
+    bucketStarts[Bucket(entry.x, entry.y)]++;
+  }
+  for (unsigned int i = 1; i <= bucketCount; i++) {
+    bucketStarts[i] += bucketStarts[i - 1];
+  }
+
+  entries.resize(scratch.size());
+  for (const auto &entry : scratch) {
+    entries[--bucketStarts[Bucket(entry.x, entry.y)]] = entry;
+  }
+
+  isDirty = false;
+}
+
+void
+SpatialHashGrid::ComputePairs(std::vector<BroadphasePair> &pairs) {
+  if (isDirty) {
+    Rebuild();
+  }
+
+  const unsigned int bucketCount = bucketStarts.size() - 1;
+  for (unsigned int bucket = 0; bucket < bucketCount; bucket++) {
+    const auto begin = bucketStarts[bucket];
+    const auto end = bucketStarts[bucket + 1];
+
+    for (unsigned int i = begin; i < end; i++) {
+      const auto &first = entries[i];
+      const auto &firstBox = boxes[first.proxy];
+
+      for (unsigned int j = i + 1; j < end; j++) {
+        const auto &second = entries[j];
+        if (first.x != second.x || first.y != second.y) {
+          continue;
+        }
+
+        // Two boxes sharing several cells would be reported from each of
+        // them; only the cell holding the corner of their intersection
+        // reports the pair.
+        const auto &secondBox = boxes[second.proxy];
+        if (!firstBox.Overlaps(secondBox) ||
+            CellCoord(std::max(firstBox.min.x, secondBox.min.x)) != first.x ||
+            CellCoord(std::max(firstBox.min.y, secondBox.min.y)) != first.y) {
+          continue;
+        }
+
+        const auto a = ids[first.proxy];
+        const auto b = ids[second.proxy];
+        pairs.push_back({std::min(a, b), std::max(a, b)});
+      }
+    }
+  }
+}
+
+void
+SpatialHashGrid::Query(const AABB &box, std::vector<unsigned int> &result) {
+  if (isDirty) {
+    Rebuild();
+  }
+
+  const int x0 = CellCoord(box.min.x);
+  const int y0 = CellCoord(box.min.y);
+  const int x1 = CellCoord(box.max.x);
+  const int y1 = CellCoord(box.max.y);
+
+  for (int y = y0; y <= y1; y++) {
+    for (int x = x0; x <= x1; x++) {
+      const auto bucket = Bucket(x, y);
+
+      for (auto i = bucketStarts[bucket]; i < bucketStarts[bucket + 1]; i++) {
+        const auto &entry = entries[i];
+        if (entry.x != x || entry.y != y) {
+          continue;
+        }
+
+        const auto &other = boxes[entry.proxy];
+        if (!box.Overlaps(other) ||
+            CellCoord(std::max(box.min.x, other.min.x)) != x ||
+            CellCoord(std::max(box.min.y, other.min.y)) != y) {
+          continue;
+        }
+
+        result.push_back(ids[entry.proxy]);
+      }
+    }
+  }
+}
@@ -0,0 +1,48 @@
+#ifndef SPATIALHASHGRID_H
+#define SPATIALHASHGRID_H
+
+#include "Broadphase.h"
+#include <vector>
+
+class SpatialHashGrid : public IBroadphase {
+private:
+  struct CellEntry {
+    int x;
+    int y;
+    unsigned int proxy;
+  };
+
+  float cellSize;
+  float inverseCellSize;
+  unsigned int bucketMask = 0;
+  bool isDirty = true;
+
+  // Proxies are stored densely and addressed through proxyOfId, so removals
+  // are a swap with the last proxy.
+  std::vector<unsigned int> proxyOfId;
+  std::vector<unsigned int> ids;
+  std::vector<AABB> boxes;
+
+  // Cell entries bucketed by hash with a counting sort; bucketStarts has one
+  // extra element so bucket i spans [bucketStarts[i], bucketStarts[i + 1]).
+  std::vector<unsigned int> bucketStarts;
+  std::vector<CellEntry> entries;
+  std::vector<CellEntry> scratch;
+
+  int CellCoord(float value) const;
+  unsigned int Bucket(int x, int y) const;
+  void Rebuild();
+
+public:
+  SpatialHashGrid(float cellSize = 64.0f);
+  virtual ~SpatialHashGrid() = default;
+
+  void Insert(unsigned int id, const AABB &box) override;
+  void Remove(unsigned int id) override;
+  void Move(unsigned int id, const AABB &box) override;
+
+  void ComputePairs(std::vector<BroadphasePair> &pairs) override;
+  void Query(const AABB &box, std::vector<unsigned int> &result) override;
+};
+
+#endif
@@ -0,0 +1,187 @@
+#include "SweepAndPrune.h"
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// A removed id stays in order until the next Sort.
+enum : unsigned char { UNTRACKED, TRACKED, REMOVED };
+
+void
+SweepAndPrune::Insert(unsigned int id, const AABB &box) {
+  if (id >= boxes.size()) {
+    boxes.resize(id + 1);
+    state.resize(id + 1, UNTRACKED);
+  }
+
+  boxes[id] = box;
+  isDirty = true;
+  if (state[id] == TRACKED) {
+    return;
+  }
+
+  // Still in order from before its removal, so it is only revived.
+  if (state[id] == REMOVED) {
+    state[id] = TRACKED;
+    pendingRemovals--;
+    return;
+  }
+
+  state[id] = TRACKED;
+  order.push_back(id);
+  insertedSinceSort++;
+}
+
+void
+SweepAndPrune::Remove(unsigned int id) {
+  if (id >= state.size() || state[id] != TRACKED) {
+    return;
+  }
+
+  state[id] = REMOVED;
+  pendingRemovals++;
+  isDirty = true;
+}
+
+void
+SweepAndPrune::Move(unsigned int id, const AABB &box) {
+  boxes[id] = box;
+  isDirty = true;
+}
+
+void
+SweepAndPrune::Sort() {
+  if (!isDirty) {
+    return;
+  }
+  isDirty = false;
+
+  if (pendingRemovals > 0) {
+    order.erase(std::remove_if(order.begin(), order.end(),
+                               [this](unsigned int id) {
+                                 if (state[id] != REMOVED) {
+                                   return false;
+                                 }
+                                 state[id] = UNTRACKED;
+                                 return true;
+                               }),
+                order.end());
+    pendingRemovals = 0;
+  }
+
+  const auto count = order.size();
+  minX.resize(count);
+  for (unsigned int i = 0; i < count; i++) {
+    minX[i] = boxes[order[i]].min.x;
+  }
+
+  // A burst of new proxies lands unsorted at the end, which would make the
+  // insertion sort quadratic.
+  if (insertedSinceSort > count / 8) {
+    std::sort(order.begin(), order.end(), [this](unsigned int a, unsigned int b) {
+      return boxes[a].min.x < boxes[b].min.x;
+    });
+    for (unsigned int i = 0; i < count; i++) {
+      minX[i] = boxes[order[i]].min.x;
+    }
+  } else {
+    for (unsigned int i = 1; i < count; i++) {
+      const float key = minX[i];
+      const unsigned int id = order[i];
+
+      unsigned int j = i;
+      while (j > 0 && minX[j - 1] > key) {
+        minX[j] = minX[j - 1];
+        order[j] = order[j - 1];
+        j--;
+      }
+
+      minX[j] = key;
+      order[j] = id;
+    }
+  }
+  insertedSinceSort = 0;
+
+  maxX.resize(count);
+  minY.resize(count);
+  maxY.resize(count);
+  for (unsigned int i = 0; i < count; i++) {
+    const auto &box = boxes[order[i]];
+    maxX[i] = box.max.x;
+    minY[i] = box.min.y;
+    maxY[i] = box.max.y;
+  }
+}
+
+void
+SweepAndPrune::ComputePairs(std::vector<BroadphasePair> &pairs) {
+  Sort();
+
+  const unsigned int count = order.size();
+  for (unsigned int i = 0; i < count; i++) {
+    const float endX = maxX[i];
+    const float lowY = minY[i];
+    const float highY = maxY[i];
+    const unsigned int a = order[i];
+
+    unsigned int j = i + 1;
+
+#ifdef __SSE2__
+    // Four candidates per step: x overlaps while minX[j] < endX because the
+    // list is sorted by minX, and y overlap is tested in the same pass.
+    const __m128 endX4 = _mm_set1_ps(endX);
+    const __m128 lowY4 = _mm_set1_ps(lowY);
+    const __m128 highY4 = _mm_set1_ps(highY);
+
+    bool isSweepDone = false;
+    while (j + 4 <= count) {
+      const __m128 xMask = _mm_cmplt_ps(_mm_loadu_ps(&minX[j]), endX4);
+      const __m128 yMask =
+          _mm_and_ps(_mm_cmplt_ps(_mm_loadu_ps(&minY[j]), highY4),
+                     _mm_cmplt_ps(lowY4, _mm_loadu_ps(&maxY[j])));
+
+      const int xBits = _mm_movemask_ps(xMask);
+      int bits = _mm_movemask_ps(_mm_and_ps(xMask, yMask));
+      while (bits) {
+        const int lane = __builtin_ctz(bits);
+        const unsigned int b = order[j + lane];
+        pairs.push_back({std::min(a, b), std::max(a, b)});
+        bits &= bits - 1;
+      }
+
+      if (xBits != 0xF) {
+        isSweepDone = true;
+        break;
+      }
+      j += 4;
+    }
+
+    if (isSweepDone) {
+      continue;
+    }
+#endif
+
+    for (; j < count && minX[j] < endX; j++) {
+      if (minY[j] < highY && lowY < maxY[j]) {
+        const unsigned int b = order[j];
+        pairs.push_back({std::min(a, b), std::max(a, b)});
+      }
+    }
+  }
+}
+
+void
+SweepAndPrune::Query(const AABB &box, std::vector<unsigned int> &result) {
+  Sort();
+
+  // Every proxy starting before box.max.x is a candidate; nothing bounds how
+  // far left a wide proxy starts, so the scan begins at the front.
+  const unsigned int end =
+      std::lower_bound(minX.begin(), minX.end(), box.max.x) - minX.begin();
+  for (unsigned int i = 0; i < end; i++) {
+    if (box.min.x < maxX[i] && minY[i] < box.max.y && box.min.y < maxY[i]) {
+      result.push_back(order[i]);
+    }
+  }
+}
@@ -0,0 +1,42 @@
+#ifndef SWEEPANDPRUNE_H
+#define SWEEPANDPRUNE_H
+
+#include "Broadphase.h"
+#include <vector>
+
+// Keeps proxies sorted by min.x between frames. Small per-frame motion leaves
+// the order almost sorted, so an insertion sort restores it in close to
+// linear time before the sweep.
+class SweepAndPrune : public IBroadphase {
+private:
+  // Indexed by id.
+  std::vector<AABB> boxes;
+  std::vector<unsigned char> state; // UNTRACKED, TRACKED or REMOVED
+
+  // Sorted along x, with the sweep's inputs gathered in the same order so the
+  // inner loop reads contiguous floats.
+  std::vector<unsigned int> order;
+  std::vector<float> minX;
+  std::vector<float> maxX;
+  std::vector<float> minY;
+  std::vector<float> maxY;
+
+  unsigned int insertedSinceSort = 0;
+  unsigned int pendingRemovals = 0;
+  bool isDirty = false;
+
+  void Sort();
+
+public:
+  SweepAndPrune() = default;
+  virtual ~SweepAndPrune() = default;
+
+  void Insert(unsigned int id, const AABB &box) override;
+  void Remove(unsigned int id) override;
+  void Move(unsigned int id, const AABB &box) override;
+
+  void ComputePairs(std::vector<BroadphasePair> &pairs) override;
+  void Query(const AABB &box, std::vector<unsigned int> &result) override;
+};
+
+#endif
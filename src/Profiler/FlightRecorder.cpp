@@ -0,0 +1,62 @@
+#include "FlightRecorder.h"
+#include "Profiler.h"
+#include <spdlog/spdlog.h>
+
+// Every spike of a trace must still be in the history when it is written.
+static_assert(FLIGHT_RECORDER_TAIL_FRAMES < PROFILER_HISTORY_FRAMES,
+              "the tail must fit in the profiler's history");
+
+FlightRecorder::FlightRecorder(double budgetMilliseconds,
+                               const std::string &directory) {
+  this->budgetMilliseconds = budgetMilliseconds;
+  this->directory = directory;
+}
+
+void
+FlightRecorder::Update() {
+  const auto &frame = Profiler::GetLastFrame();
+  // The first frame spans startup, and the frame after a write includes it.
+  if (budgetMilliseconds <= 0 || frame.index == 0 ||
+      frame.index == skippedFrame) {
+    return;
+  }
+
+  const double milliseconds = Profiler::ToMilliseconds(frame.end - frame.start);
+  if (milliseconds > budgetMilliseconds) {
+    spikeCount++;
+    if (pendingSpikeCount == 0) {
+      firstSpike = frame.index;
+      writeFrame = frame.index + FLIGHT_RECORDER_TAIL_FRAMES;
+    }
+    pendingSpikeCount++;
+    PROFILE_EVENT("Frame over budget", nullptr, frame.index);
+    spdlog::warn("Frame " + std::to_string(frame.index) + " took " +
+                 std::to_string(milliseconds) + " ms, over the " +
+                 std::to_string(budgetMilliseconds) + " ms budget");
+  }
+
+  if (pendingSpikeCount > 0 && frame.index >= writeFrame) {
+    Write();
+    skippedFrame = frame.index + 1;
+  }
+}
+
+void
+FlightRecorder::Flush() {
+  if (pendingSpikeCount > 0) {
+    Write();
+  }
+}
+
+void
+FlightRecorder::Write() {
+  const std::string path =
+      directory + "/spike-" + std::to_string(firstSpike) + ".json";
+  spdlog::warn("Writing " + std::to_string(pendingSpikeCount) +
+               " over-budget frames from frame " + std::to_string(firstSpike) +
+               " on to " + path);
+  if (Profiler::WriteTrace(path)) {
+    traceCount++;
+  }
+  pendingSpikeCount = 0;
+}
@@ -0,0 +1,45 @@
+#ifndef FLIGHTRECORDER_H
+#define FLIGHTRECORDER_H
+
+#include <cstdint>
+#include <string>
+
+const unsigned int FLIGHT_RECORDER_TAIL_FRAMES = 60; // traced after a spike
+
+// Watches the profiler's frames and, when one runs over budget, writes the
+// profiler's history as a Chrome trace FLIGHT_RECORDER_TAIL_FRAMES later, so
+// the trace shows what led up to the spike and how the game recovered.
+// Spikes while a trace is pending land in that trace, each marked with a
+// "Frame over budget" event. The history is the profiler's own, so only a
+// spike pays for writing a file.
+class FlightRecorder {
+private:
+  double budgetMilliseconds;
+  std::string directory;
+  uint64_t firstSpike = 0; // of the pending trace
+  uint64_t writeFrame = 0; // when the pending trace is written
+  uint64_t skippedFrame = 0;
+  unsigned int pendingSpikeCount = 0;
+  unsigned int spikeCount = 0;
+  unsigned int traceCount = 0;
+
+  void Write();
+
+public:
+  // A budget of 0 never writes a trace.
+  FlightRecorder(double budgetMilliseconds,
+                 const std::string &directory = ".");
+
+  // Checks the profiler's last frame; call after each PROFILE_FRAME.
+  void Update();
+
+  // Writes a pending trace without waiting for the frames after its spike,
+  // e.g. when the game quits.
+  void Flush();
+
+  double GetBudget() const { return budgetMilliseconds; }
+  unsigned int GetSpikeCount() const { return spikeCount; }
+  unsigned int GetTraceCount() const { return traceCount; }
+};
+
+#endif
@@ -0,0 +1,43 @@
+#include "MemoryTracker.h"
+#include <algorithm>
+#include <cstring>
+
+static bool
+IsSameName(const char *name, const char *other) {
+  return name == other || std::strcmp(name, other) == 0;
+}
+
+void
+MemoryTracker::Record(const char *category, const char *name,
+                      size_t reservedBytes, size_t usedBytes) {
+  for (auto &usage : usages) {
+    if (IsSameName(usage.name, name) && IsSameName(usage.category, category)) {
+      usage.reservedBytes = reservedBytes;
+      usage.usedBytes = usedBytes;
+      usage.peakReservedBytes =
+          std::max(usage.peakReservedBytes, reservedBytes);
+      usage.peakUsedBytes = std::max(usage.peakUsedBytes, usedBytes);
+      return;
+    }
+  }
+  usages.push_back(
+      {category, name, reservedBytes, usedBytes, reservedBytes, usedBytes});
+}
+
+size_t
+MemoryTracker::GetReservedBytes() const {
+  size_t bytes = 0;
+  for (const auto &usage : usages) {
+    bytes += usage.reservedBytes;
+  }
+  return bytes;
+}
+
+size_t
+MemoryTracker::GetUsedBytes() const {
+  size_t bytes = 0;
+  for (const auto &usage : usages) {
+    bytes += usage.usedBytes;
+  }
+  return bytes;
+}
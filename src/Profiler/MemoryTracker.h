@@ -0,0 +1,39 @@
+#ifndef MEMORYTRACKER_H
+#define MEMORYTRACKER_H
+
+#include <cstddef>
+#include <vector>
+
+// Bytes held by one container. Reserved is what it has allocated and used
+// the part holding live data; the difference is slack. Peaks are the highest
+// values reported so far.
+struct MemoryUsage {
+  const char *category;
+  const char *name; // may be a mangled type name, see Profiler::Demangle
+  size_t reservedBytes;
+  size_t usedBytes;
+  size_t peakReservedBytes;
+  size_t peakUsedBytes;
+};
+
+// Collects the sizes subsystems report, such as Registry::ReportMemory, and
+// keeps their high-water marks. Reporting once per frame is cheap: entries
+// are found by name pointer and no strings are built. Names must outlive the
+// tracker; string literals and typeid names do.
+class MemoryTracker {
+private:
+  std::vector<MemoryUsage> usages;
+
+public:
+  MemoryTracker() = default;
+  ~MemoryTracker() = default;
+
+  void Record(const char *category, const char *name, size_t reservedBytes,
+              size_t usedBytes);
+
+  const std::vector<MemoryUsage> &GetUsages() const { return usages; }
+  size_t GetReservedBytes() const;
+  size_t GetUsedBytes() const;
+};
+
+#endif
@@ -0,0 +1,269 @@
+#include "Profiler.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <spdlog/spdlog.h>
+
+#ifdef __GNUG__
+#include <cxxabi.h>
+#endif
+
+thread_local ProfileThreadBuffer *Profiler::threadBuffer = nullptr;
+
+// Buffers outlive their threads so zones recorded just before a thread exits
+// are still drained.
+static std::mutex buffersMutex;
+static std::vector<std::unique_ptr<ProfileThreadBuffer>> buffers;
+
+// Ticks are converted with the rate measured against the steady clock since
+// startup, which gets more precise the longer the game runs.
+static const uint64_t originTicks = Profiler::Now();
+static const auto originTime = std::chrono::steady_clock::now();
+static double millisecondsPerTick = 0;
+
+static std::deque<ProfileFrame> frames;
+static std::vector<ProfileCounter> counters; // for the current frame
+static uint64_t frameCount = 0;
+static uint64_t frameStart = originTicks;
+
+static void
+Calibrate() {
+#if defined(__x86_64__) || defined(__i386__)
+  const double elapsedTicks = Profiler::Now() - originTicks;
+  const double elapsedMilliseconds =
+      std::chrono::duration<double, std::milli>(
+          std::chrono::steady_clock::now() - originTime)
+          .count();
+  if (elapsedTicks > 0 && elapsedMilliseconds > 0) {
+    millisecondsPerTick = elapsedMilliseconds / elapsedTicks;
+  }
+#else
+  millisecondsPerTick = 1e-6;
+#endif
+}
+
+ProfileThreadBuffer *
+Profiler::RegisterThread() {
+  std::lock_guard<std::mutex> lock(buffersMutex);
+  buffers.push_back(std::make_unique<ProfileThreadBuffer>());
+
+  auto *buffer = buffers.back().get();
+  buffer->thread = buffers.size() - 1;
+  buffer->name = "Thread " + std::to_string(buffer->thread);
+  return buffer;
+}
+
+void
+Profiler::SetThreadName(const std::string &name) {
+  auto &buffer = GetThreadBuffer();
+  std::lock_guard<std::mutex> lock(buffersMutex);
+  buffer.name = name;
+}
+
+std::vector<std::string>
+Profiler::GetThreadNames() {
+  std::lock_guard<std::mutex> lock(buffersMutex);
+  std::vector<std::string> names;
+  for (const auto &buffer : buffers) {
+    names.push_back(buffer->name);
+  }
+  return names;
+}
+
+double
+Profiler::ToMilliseconds(uint64_t ticks) {
+  if (millisecondsPerTick == 0) {
+    Calibrate();
+  }
+  return ticks * millisecondsPerTick;
+}
+
+void
+Profiler::SetCounter(const char *name, double value) {
+  for (auto &counter : counters) {
+    if (counter.name == name || std::strcmp(counter.name, name) == 0) {
+      counter.value = value;
+      return;
+    }
+  }
+  counters.push_back({name, value});
+}
+
+void
+Profiler::EndFrame() {
+  const uint64_t frameEnd = Now();
+  Calibrate();
+
+  // The oldest frame is reused, so its vectors keep their capacity.
+  ProfileFrame frame;
+  if (frames.size() >= PROFILER_HISTORY_FRAMES) {
+    frame = std::move(frames.front());
+    frames.pop_front();
+  }
+  frame.index = frameCount++;
+  frame.start = frameStart;
+  frame.end = frameEnd;
+  frame.thread = GetThreadBuffer().thread;
+  frame.droppedCount = 0;
+  frame.zones.clear();
+  frame.totals.clear();
+  frame.counters.swap(counters);
+  counters.clear();
+  frameStart = frameEnd;
+
+  {
+    std::lock_guard<std::mutex> lock(buffersMutex);
+    for (auto &buffer : buffers) {
+      const uint32_t read = buffer->readIndex.load(std::memory_order_relaxed);
+      const uint32_t write =
+          buffer->writeIndex.load(std::memory_order_acquire);
+      for (uint32_t i = read; i != write; i++) {
+        frame.zones.push_back(buffer->zones[i % PROFILER_BUFFER_SIZE]);
+      }
+      buffer->readIndex.store(write, std::memory_order_release);
+
+      const uint64_t dropped =
+          buffer->droppedCount.exchange(0, std::memory_order_relaxed);
+      if (dropped > 0) {
+        spdlog::warn("Profiler dropped " + std::to_string(dropped) +
+                     " zones of " + buffer->name + " in frame " +
+                     std::to_string(frame.index) +
+                     ", more than PROFILER_BUFFER_SIZE");
+        frame.droppedCount += dropped;
+      }
+    }
+  }
+
+  for (const auto &zone : frame.zones) {
+    if (zone.isEvent) {
+      continue;
+    }
+    const double milliseconds = ToMilliseconds(zone.end - zone.start);
+
+    bool isFound = false;
+    for (auto &total : frame.totals) {
+      if (total.name == zone.name || std::strcmp(total.name, zone.name) == 0) {
+        total.milliseconds += milliseconds;
+        total.calls++;
+        isFound = true;
+        break;
+      }
+    }
+    if (!isFound) {
+      frame.totals.push_back({zone.name, milliseconds, 1});
+    }
+  }
+
+  frames.push_back(std::move(frame));
+}
+
+const ProfileFrame &
+Profiler::GetLastFrame() {
+  static const ProfileFrame emptyFrame;
+  return frames.empty() ? emptyFrame : frames.back();
+}
+
+const std::deque<ProfileFrame> &
+Profiler::GetFrames() {
+  return frames;
+}
+
+std::string
+Profiler::Demangle(const char *name) {
+#ifdef __GNUG__
+  int status = 0;
+  std::unique_ptr<char, void (*)(void *)> demangled(
+      abi::__cxa_demangle(name, nullptr, nullptr, &status), std::free);
+  if (status == 0) {
+    return demangled.get();
+  }
+#endif
+  return name;
+}
+
+// Microseconds since startup, the unit of trace timestamps.
+static double
+ToTraceTime(uint64_t ticks) {
+  const auto elapsed = static_cast<int64_t>(ticks - originTicks);
+  return elapsed < 0 ? -Profiler::ToMilliseconds(-elapsed) * 1000.0
+                     : Profiler::ToMilliseconds(elapsed) * 1000.0;
+}
+
+bool
+Profiler::WriteTrace(const std::string &path, unsigned int frameLimit) {
+  FILE *file = std::fopen(path.c_str(), "w");
+  if (!file) {
+    spdlog::error("Error opening trace file " + path);
+    return false;
+  }
+
+  std::fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+  std::fprintf(file, "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, "
+                     "\"args\": {\"name\": \"game-engine\"}}");
+  const auto threadNames = GetThreadNames();
+  for (unsigned int i = 0; i < threadNames.size(); i++) {
+    std::fprintf(file,
+                 ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, "
+                 "\"tid\": %u, \"args\": {\"name\": \"%s\"}}",
+                 i, threadNames[i].c_str());
+  }
+
+  const size_t first =
+      frames.size() > frameLimit ? frames.size() - frameLimit : 0;
+  for (size_t i = first; i < frames.size(); i++) {
+    const auto &frame = frames[i];
+    std::fprintf(file,
+                 ",\n{\"name\": \"Frame %llu\", \"cat\": \"frame\", "
+                 "\"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, "
+                 "\"dur\": %.3f}",
+                 static_cast<unsigned long long>(frame.index), frame.thread,
+                 ToTraceTime(frame.start),
+                 ToMilliseconds(frame.end - frame.start) * 1000.0);
+
+    // A frame with dropped zones is missing part of its timeline.
+    std::fprintf(file,
+                 ",\n{\"name\": \"Dropped zones\", \"ph\": \"C\", "
+                 "\"pid\": 1, \"ts\": %.3f, \"args\": {\"value\": %llu}}",
+                 ToTraceTime(frame.start),
+                 static_cast<unsigned long long>(frame.droppedCount));
+
+    for (const auto &zone : frame.zones) {
+      if (zone.isEvent) {
+        std::fprintf(file,
+                     ",\n{\"name\": \"%s\", \"ph\": \"i\", \"s\": \"t\", "
+                     "\"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"args\": "
+                     "{\"detail\": \"%s\", \"value\": %u}}",
+                     zone.name, zone.thread, ToTraceTime(zone.start),
+                     zone.detail ? Demangle(zone.detail).c_str() : "",
+                     zone.value);
+        continue;
+      }
+      std::fprintf(file,
+                   ",\n{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, "
+                   "\"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+                   zone.name, zone.thread, ToTraceTime(zone.start),
+                   ToMilliseconds(zone.end - zone.start) * 1000.0);
+    }
+
+    for (const auto &counter : frame.counters) {
+      std::fprintf(file,
+                   ",\n{\"name\": \"%s\", \"ph\": \"C\", \"pid\": 1, "
+                   "\"ts\": %.3f, \"args\": {\"value\": %g}}",
+                   counter.name, ToTraceTime(frame.start), counter.value);
+    }
+  }
+  std::fprintf(file, "\n]}\n");
+
+  const bool isWritten = std::ferror(file) == 0;
+  std::fclose(file);
+  if (!isWritten) {
+    spdlog::error("Error writing trace file " + path);
+    return false;
+  }
+
+  spdlog::info("Wrote " + std::to_string(frames.size() - first) +
+               " profiled frames to " + path);
+  return true;
+}
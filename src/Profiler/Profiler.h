@@ -0,0 +1,181 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+const unsigned int PROFILER_BUFFER_SIZE = 1 << 16; // zones per thread
+const unsigned int PROFILER_HISTORY_FRAMES = 300;   // kept for traces
+
+// A finished zone, or an instant event such as an entity being created.
+// Depth counts the zones it is nested in on its thread.
+struct ProfileZone {
+  const char *name;
+  const char *detail; // events: what the event applies to, or null
+  uint64_t start;
+  uint64_t end; // events: equal to start
+  uint32_t depth;
+  uint32_t thread;
+  uint32_t value; // events: an argument such as the entity id
+  bool isEvent;
+};
+
+struct ProfileZoneTotal {
+  const char *name;
+  double milliseconds;
+  unsigned int calls;
+};
+
+// A value sampled once per frame, such as the entity count.
+struct ProfileCounter {
+  const char *name;
+  double value;
+};
+
+struct ProfileFrame {
+  uint64_t index = 0;
+  uint64_t start = 0;
+  uint64_t end = 0;
+  uint32_t thread = 0; // the thread that ended the frame
+  uint64_t droppedCount = 0; // zones lost to full rings, over every thread
+  std::vector<ProfileZone> zones;
+  std::vector<ProfileZoneTotal> totals; // per name, over every thread
+  std::vector<ProfileCounter> counters;
+};
+
+// Zones finished on one thread, in a ring written only by that thread and
+// drained only by EndFrame, so neither side takes a lock. A full ring drops
+// new zones until the next drain and counts them, so EndFrame can report
+// the loss.
+struct ProfileThreadBuffer {
+  ProfileZone zones[PROFILER_BUFFER_SIZE];
+  std::atomic<uint32_t> writeIndex{0};
+  std::atomic<uint32_t> readIndex{0};
+  uint32_t depth = 0;
+  uint32_t thread = 0;
+  std::atomic<uint64_t> droppedCount{0};
+  std::string name;
+};
+
+// Collects zones from every thread and groups them by frame. Timestamps are
+// raw ticks (the TSC on x86, nanoseconds elsewhere); ToMilliseconds converts
+// them.
+class Profiler {
+private:
+  static thread_local ProfileThreadBuffer *threadBuffer;
+
+  static ProfileThreadBuffer *RegisterThread();
+
+public:
+  static uint64_t Now() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#endif
+  }
+
+  static ProfileThreadBuffer &GetThreadBuffer() {
+    if (!threadBuffer) {
+      threadBuffer = RegisterThread();
+    }
+    return *threadBuffer;
+  }
+
+  static void Record(ProfileThreadBuffer &buffer, const ProfileZone &zone) {
+    const uint32_t write = buffer.writeIndex.load(std::memory_order_relaxed);
+    if (write - buffer.readIndex.load(std::memory_order_acquire) >=
+        PROFILER_BUFFER_SIZE) {
+      buffer.droppedCount.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    buffer.zones[write % PROFILER_BUFFER_SIZE] = zone;
+    buffer.writeIndex.store(write + 1, std::memory_order_release);
+  }
+
+  static void RecordEvent(const char *name, const char *detail,
+                          uint32_t value) {
+    auto &buffer = GetThreadBuffer();
+    const uint64_t now = Now();
+    Record(buffer, {name, detail, now, now, buffer.depth, buffer.thread, value,
+                    true});
+  }
+
+  static void SetThreadName(const std::string &name);
+
+  // Sets a counter for the current frame. Only the thread that ends frames
+  // may set counters.
+  static void SetCounter(const char *name, double value);
+
+  // Drains every thread's zones into a new frame and totals them. The last
+  // PROFILER_HISTORY_FRAMES frames are kept.
+  static void EndFrame();
+  static const ProfileFrame &GetLastFrame();
+  static const std::deque<ProfileFrame> &GetFrames();
+
+  // Writes the last frameLimit frames in the Chrome trace event format, for
+  // chrome://tracing or Perfetto. Zone and counter names are written as is,
+  // so they must not need JSON escaping.
+  static bool WriteTrace(const std::string &path,
+                         unsigned int frameLimit = PROFILER_HISTORY_FRAMES);
+
+  static double ToMilliseconds(uint64_t ticks);
+  static std::vector<std::string> GetThreadNames();
+
+  // Type names from typeid are mangled; a class name becomes its length
+  // followed by the name.
+  static std::string Demangle(const char *name);
+};
+
+// Times the enclosing scope as a zone. The name must outlive the profiler; a
+// string literal does.
+class ProfileScope {
+private:
+  ProfileThreadBuffer &buffer;
+  const char *name;
+  uint64_t start;
+
+public:
+  explicit ProfileScope(const char *name)
+      : buffer(Profiler::GetThreadBuffer()), name(name) {
+    buffer.depth++;
+    start = Profiler::Now();
+  }
+  ~ProfileScope() {
+    const uint64_t end = Profiler::Now();
+    buffer.depth--;
+    Profiler::Record(buffer, {name, nullptr, start, end, buffer.depth,
+                              buffer.thread, 0, false});
+  }
+};
+
+#ifdef ENABLE_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name)                                                    \
+  ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FRAME() Profiler::EndFrame()
+#define PROFILE_THREAD(name) Profiler::SetThreadName(name)
+#define PROFILE_COUNTER(name, value) Profiler::SetCounter(name, value)
+#define PROFILE_EVENT(name, detail, value)                                     \
+  Profiler::RecordEvent(name, detail, value)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FRAME()
+#define PROFILE_THREAD(name)
+#define PROFILE_COUNTER(name, value)
+#define PROFILE_EVENT(name, detail, value)
+#endif
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include "../Physics/AABB.h"
+#include <SDL2/SDL.h>
+#include <glm/glm.hpp>
+
+struct Camera {
+  glm::vec2 position; // world position of the viewport's top-left corner
+  float zoom;
+  SDL_Rect viewport;
+
+  Camera(glm::vec2 position = glm::vec2(0, 0), float zoom = 1.0f,
+         SDL_Rect viewport = {0, 0, 0, 0}) {
+    this->position = position;
+    this->zoom = zoom;
+    this->viewport = viewport;
+  }
+
+  AABB GetWorldBounds() const {
+    return AABB(position,
+                position + glm::vec2(viewport.w, viewport.h) / zoom);
+  }
+
+  glm::vec2 WorldToScreen(glm::vec2 world) const {
+    return (world - position) * zoom + glm::vec2(viewport.x, viewport.y);
+  }
+};
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef FRAMEARENA_H
+#define FRAMEARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+const size_t FRAME_ARENA_SIZE = 4 * 1024 * 1024;
+
+// Bump allocator for scratch data that lives for a single frame. Reset hands
+// everything back at once; a frame that outgrew the buffer spills into extra
+// blocks, and the next Reset merges them into one buffer big enough for both.
+class FrameArena {
+private:
+  std::unique_ptr<unsigned char[]> buffer;
+  size_t capacity = 0;
+  size_t used = 0;
+  std::vector<std::unique_ptr<unsigned char[]>> overflow;
+  size_t overflowSize = 0;
+  size_t highWaterMark = 0;
+
+public:
+  FrameArena(size_t capacity = FRAME_ARENA_SIZE) {
+    this->buffer = std::make_unique<unsigned char[]>(capacity);
+    this->capacity = capacity;
+  }
+  ~FrameArena() = default;
+
+  template <typename T> T *Allocate(size_t count) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "FrameArena never runs destructors");
+
+    const size_t size = count * sizeof(T);
+    const size_t start = (used + alignof(T) - 1) & ~(alignof(T) - 1);
+    if (start + size <= capacity) {
+      used = start + size;
+      highWaterMark = std::max(highWaterMark, used + overflowSize);
+      return reinterpret_cast<T *>(buffer.get() + start);
+    }
+
+    // new[] of unsigned char is aligned for any fundamental type.
+    overflow.push_back(std::make_unique<unsigned char[]>(size));
+    overflowSize += size;
+    highWaterMark = std::max(highWaterMark, used + overflowSize);
+    return reinterpret_cast<T *>(overflow.back().get());
+  }
+
+  void Reset() {
+    if (!overflow.empty()) {
+      capacity += overflowSize;
+      buffer = std::make_unique<unsigned char[]>(capacity);
+      overflow.clear();
+      overflowSize = 0;
+    }
+    used = 0;
+  }
+
+  size_t GetCapacity() const { return capacity; }
+  size_t GetHighWaterMark() const { return highWaterMark; }
+};
+
+#endif
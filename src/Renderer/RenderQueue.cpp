@@ -0,0 +1,217 @@
+#include "RenderQueue.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+const int DEPTH_BITS = 24;
+const int RADIX_BITS = 11;
+const int RADIX_MAX_PASSES = (64 + RADIX_BITS - 1) / RADIX_BITS;
+const unsigned int RADIX_BUCKETS = 1u << RADIX_BITS;
+
+uint64_t
+RenderQueue::MakeKey(int layer, float depth, unsigned int textureId,
+                     SDL_BlendMode blendMode) {
+  const uint64_t layerBits = std::clamp(layer, -128, 127) + 128;
+
+  const float depthBias = 1 << (DEPTH_BITS - 1);
+  const float depthMax = (1 << DEPTH_BITS) - 1;
+  const uint64_t depthBits = static_cast<uint64_t>(
+      std::clamp(std::floor(depth) + depthBias, 0.0f, depthMax));
+
+  return layerBits << 56 | depthBits << 32 |
+         static_cast<uint64_t>(textureId & 0xFFFF) << 16 |
+         static_cast<uint64_t>(blendMode & 0xFF) << 8;
+}
+
+void
+RenderQueue::Begin() {
+  items.clear();
+  keys.clear();
+  arena.Reset();
+  order = nullptr;
+  anyBits = 0;
+  allBits = ~0ull;
+}
+
+void
+RenderQueue::Push(uint64_t key, const RenderItem &item) {
+  keys.push_back(key);
+  items.push_back(item);
+  anyBits |= key;
+  allBits &= key;
+}
+
+// Only the bits that differ between keys decide the order. A typical frame
+// has a few layers, a screen's height of depths and a handful of textures,
+// about 20 varying bits, so those are packed into 32 and sorted with the
+// item index in a single 64-bit word. Wider keys fall back to sorting the
+// full keys.
+void
+RenderQueue::Sort() {
+  const unsigned int count = keys.size();
+  const uint64_t varyingBits = anyBits ^ allBits;
+  const int keyBits = __builtin_popcountll(varyingBits);
+
+  if (count < 2 || keyBits == 0) {
+    unsigned int *indices = arena.Allocate<unsigned int>(count);
+    for (unsigned int i = 0; i < count; i++) {
+      indices[i] = i;
+    }
+    order = indices;
+  } else if (keyBits <= 32) {
+    SortNarrowKeys(varyingBits, keyBits);
+  } else {
+    SortWideKeys(varyingBits);
+  }
+}
+
+// Gathers each run of varying bits next to the previous one, then sorts the
+// packed keys in passes that split their bits evenly, so 20 bits take two
+// passes of 10. The last pass writes the item indices straight into the
+// order.
+void
+RenderQueue::SortNarrowKeys(uint64_t varyingBits, int keyBits) {
+  const unsigned int count = keys.size();
+
+  int runShifts[32];
+  uint64_t runMasks[32];
+  int runOffsets[32];
+  int runCount = 0;
+  int packedBits = 0;
+  for (int bit = 0; bit < 64;) {
+    if (!((varyingBits >> bit) & 1)) {
+      bit++;
+      continue;
+    }
+    int end = bit;
+    while (end < 64 && ((varyingBits >> end) & 1)) {
+      end++;
+    }
+    runShifts[runCount] = bit;
+    runMasks[runCount] = (1ull << (end - bit)) - 1;
+    runOffsets[runCount] = packedBits;
+    runCount++;
+    packedBits += end - bit;
+    bit = end;
+  }
+
+  const int passCount = (keyBits + RADIX_BITS - 1) / RADIX_BITS;
+  const int passBits = (keyBits + passCount - 1) / passCount;
+  const uint64_t passMask = (1ull << passBits) - 1;
+
+  unsigned int histograms[RADIX_MAX_PASSES][RADIX_BUCKETS];
+  std::memset(histograms, 0, passCount * sizeof(histograms[0]));
+
+  uint64_t *pairs = arena.Allocate<uint64_t>(count);
+  uint64_t *pairsOut = arena.Allocate<uint64_t>(count);
+  unsigned int *indices = arena.Allocate<unsigned int>(count);
+
+  for (unsigned int i = 0; i < count; i++) {
+    const uint64_t key = keys[i];
+    uint64_t packed = 0;
+    for (int r = 0; r < runCount; r++) {
+      packed |= ((key >> runShifts[r]) & runMasks[r]) << runOffsets[r];
+    }
+    pairs[i] = packed << 32 | i;
+  }
+
+  // Counting in a loop of its own is faster than counting while packing.
+  for (unsigned int i = 0; i < count; i++) {
+    const uint64_t packed = pairs[i] >> 32;
+    for (int p = 0; p < passCount; p++) {
+      histograms[p][(packed >> (p * passBits)) & passMask]++;
+    }
+  }
+
+  for (int p = 0; p < passCount; p++) {
+    const int shift = 32 + p * passBits;
+    auto &histogram = histograms[p];
+
+    unsigned int offset = 0;
+    for (unsigned int bucket = 0; bucket <= passMask; bucket++) {
+      const unsigned int bucketSize = histogram[bucket];
+      histogram[bucket] = offset;
+      offset += bucketSize;
+    }
+
+    if (p == passCount - 1) {
+      for (unsigned int i = 0; i < count; i++) {
+        const uint64_t pair = pairs[i];
+        indices[histogram[(pair >> shift) & passMask]++] =
+            static_cast<unsigned int>(pair);
+      }
+    } else {
+      for (unsigned int i = 0; i < count; i++) {
+        const uint64_t pair = pairs[i];
+        pairsOut[histogram[(pair >> shift) & passMask]++] = pair;
+      }
+      std::swap(pairs, pairsOut);
+    }
+  }
+
+  order = indices;
+}
+
+// Sorts (key, index) pairs 11 bits at a time from the least significant up,
+// starting each pass at the lowest bit still varying. The histograms of all
+// passes come from a single read of the keys.
+void
+RenderQueue::SortWideKeys(uint64_t varyingBits) {
+  const unsigned int count = keys.size();
+
+  int shifts[RADIX_MAX_PASSES];
+  int passCount = 0;
+  for (int bit = 0; bit < 64;) {
+    if ((varyingBits >> bit) & 1) {
+      shifts[passCount++] = bit;
+      bit += RADIX_BITS;
+    } else {
+      bit++;
+    }
+  }
+
+  unsigned int histograms[RADIX_MAX_PASSES][RADIX_BUCKETS];
+  std::memset(histograms, 0, passCount * sizeof(histograms[0]));
+  for (unsigned int i = 0; i < count; i++) {
+    const uint64_t key = keys[i];
+    for (int p = 0; p < passCount; p++) {
+      histograms[p][(key >> shifts[p]) & (RADIX_BUCKETS - 1)]++;
+    }
+  }
+
+  unsigned int *indices = arena.Allocate<unsigned int>(count);
+  for (unsigned int i = 0; i < count; i++) {
+    indices[i] = i;
+  }
+
+  // The queue's own keys are not needed after the sort, so they serve as
+  // the second buffer.
+  uint64_t *keysIn = keys.data();
+  uint64_t *keysOut = arena.Allocate<uint64_t>(count);
+  unsigned int *indicesOut = arena.Allocate<unsigned int>(count);
+
+  for (int p = 0; p < passCount; p++) {
+    const int shift = shifts[p];
+    auto &histogram = histograms[p];
+
+    unsigned int offset = 0;
+    for (unsigned int bucket = 0; bucket < RADIX_BUCKETS; bucket++) {
+      const unsigned int bucketSize = histogram[bucket];
+      histogram[bucket] = offset;
+      offset += bucketSize;
+    }
+
+    for (unsigned int i = 0; i < count; i++) {
+      const uint64_t key = keysIn[i];
+      const unsigned int slot =
+          histogram[(key >> shift) & (RADIX_BUCKETS - 1)]++;
+      keysOut[slot] = key;
+      indicesOut[slot] = indices[i];
+    }
+
+    std::swap(keysIn, keysOut);
+    std::swap(indices, indicesOut);
+  }
+
+  order = indices;
+}
@@ -0,0 +1,58 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include "FrameArena.h"
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <vector>
+
+struct RenderItem {
+  SDL_Texture *texture;
+  SDL_Rect srcRect;
+  SDL_FRect dstRect;
+  double rotation;
+  SDL_Color color;
+  SDL_BlendMode blendMode;
+};
+
+// A frame's draws, each with a 64-bit key packing, from the most significant
+// bits down: layer (8), depth (24), texture id (16) and blend mode (8). Sort
+// orders them with a stable LSD radix sort, so within a layer sprites lower
+// on screen are drawn over the ones above them, and equal depths end up next
+// to each other by texture for batching.
+class RenderQueue {
+private:
+  std::vector<RenderItem> items;
+  std::vector<uint64_t> keys;
+  FrameArena arena;
+  const unsigned int *order = nullptr;
+
+  // Bits set in any key and in every key, gathered as items are pushed.
+  uint64_t anyBits = 0;
+  uint64_t allBits = ~0ull;
+
+  void SortNarrowKeys(uint64_t varyingBits, int keyBits);
+  void SortWideKeys(uint64_t varyingBits);
+
+public:
+  RenderQueue() = default;
+  ~RenderQueue() = default;
+
+  // Layers range from -128 to 127 and depth is a screen y coordinate; both
+  // are clamped to their bits.
+  static uint64_t MakeKey(int layer, float depth, unsigned int textureId,
+                          SDL_BlendMode blendMode);
+
+  void Begin();
+  void Push(uint64_t key, const RenderItem &item);
+  void Sort();
+
+  unsigned int GetCount() const { return items.size(); }
+  // Only valid after Sort.
+  const RenderItem &GetSorted(unsigned int i) const {
+    return items[order[i]];
+  }
+  const FrameArena &GetArena() const { return arena; }
+};
+
+#endif
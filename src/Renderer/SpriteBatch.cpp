@@ -0,0 +1,122 @@
+#include "SpriteBatch.h"
+#include <cmath>
+#include <glm/glm.hpp>
+
+void
+SpriteBatch::Begin() {
+  for (unsigned int i = 0; i < batchCount; i++) {
+    batches[i].vertices.clear();
+  }
+
+  batchCount = 0;
+  drawCallCount = 0;
+  quadCount = 0;
+}
+
+void
+SpriteBatch::QueryTextureSize(Batch &batch) {
+  batch.textureWidth = 1;
+  batch.textureHeight = 1;
+  if (batch.texture) {
+    SDL_QueryTexture(batch.texture, nullptr, nullptr, &batch.textureWidth,
+                     &batch.textureHeight);
+  }
+  batch.inverseWidth = 1.0f / batch.textureWidth;
+  batch.inverseHeight = 1.0f / batch.textureHeight;
+}
+
+SpriteBatch::Batch &
+SpriteBatch::CurrentBatch(SDL_Texture *texture, SDL_BlendMode blendMode) {
+  if (batchCount > 0 && batches[batchCount - 1].texture == texture &&
+      batches[batchCount - 1].blendMode == blendMode) {
+    return batches[batchCount - 1];
+  }
+
+  if (batchCount == batches.size()) {
+    batches.emplace_back();
+  }
+
+  // Sizes are re-read for every run in case a texture was replaced.
+  auto &batch = batches[batchCount++];
+  batch.texture = texture;
+  batch.blendMode = blendMode;
+  QueryTextureSize(batch);
+  return batch;
+}
+
+void
+SpriteBatch::Draw(SDL_Texture *texture, const SDL_Rect &srcRect,
+                  const SDL_FRect &dstRect, double rotation, SDL_Color color,
+                  SDL_BlendMode blendMode) {
+  auto &batch = CurrentBatch(texture, blendMode);
+
+  SDL_Rect source = srcRect;
+  if (source.w == 0 || source.h == 0) {
+    source = {0, 0, batch.textureWidth, batch.textureHeight};
+  }
+
+  const float u0 = source.x * batch.inverseWidth;
+  const float v0 = source.y * batch.inverseHeight;
+  const float u1 = (source.x + source.w) * batch.inverseWidth;
+  const float v1 = (source.y + source.h) * batch.inverseHeight;
+
+  const float halfWidth = dstRect.w * 0.5f;
+  const float halfHeight = dstRect.h * 0.5f;
+  const float centerX = dstRect.x + halfWidth;
+  const float centerY = dstRect.y + halfHeight;
+
+  // Corners relative to the center, clockwise from the top-left.
+  const float cornersX[4] = {-halfWidth, halfWidth, halfWidth, -halfWidth};
+  const float cornersY[4] = {-halfHeight, -halfHeight, halfHeight, halfHeight};
+  const float cornersU[4] = {u0, u1, u1, u0};
+  const float cornersV[4] = {v0, v0, v1, v1};
+
+  float cosine = 1.0f;
+  float sine = 0.0f;
+  if (rotation != 0.0) {
+    const double radians = glm::radians(rotation);
+    cosine = static_cast<float>(std::cos(radians));
+    sine = static_cast<float>(std::sin(radians));
+  }
+
+  for (int i = 0; i < 4; i++) {
+    SDL_Vertex vertex;
+    vertex.position.x = centerX + cornersX[i] * cosine - cornersY[i] * sine;
+    vertex.position.y = centerY + cornersX[i] * sine + cornersY[i] * cosine;
+    vertex.color = color;
+    vertex.tex_coord.x = cornersU[i];
+    vertex.tex_coord.y = cornersV[i];
+    batch.vertices.push_back(vertex);
+  }
+
+  quadCount++;
+}
+
+void
+SpriteBatch::Flush(SDL_Renderer *renderer) {
+  for (unsigned int i = 0; i < batchCount; i++) {
+    const auto &batch = batches[i];
+    drawCallCount++;
+
+    // Without a renderer (headless runs) batches are only counted.
+    if (!renderer) {
+      continue;
+    }
+
+    const int quads = batch.vertices.size() / 4;
+    while (indices.size() < static_cast<size_t>(quads) * 6) {
+      const int base = indices.size() / 6 * 4;
+      indices.insert(indices.end(),
+                     {base, base + 1, base + 2, base + 2, base + 3, base});
+    }
+
+    if (batch.texture) {
+      SDL_SetTextureBlendMode(batch.texture, batch.blendMode);
+    } else {
+      SDL_SetRenderDrawBlendMode(renderer, batch.blendMode);
+    }
+
+    SDL_RenderGeometry(renderer, batch.texture, batch.vertices.data(),
+                       batch.vertices.size(), indices.data(), quads * 6);
+  }
+}
@@ -0,0 +1,52 @@
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+
+#include <SDL2/SDL.h>
+#include <vector>
+
+// Collects a frame's quads into runs of consecutive draws sharing a texture
+// and blend mode, and submits each run with a single SDL_RenderGeometry call
+// in the order drawn. Callers sort their draws (see RenderQueue) to keep runs
+// long. Rotation is applied to the vertices on the CPU.
+class SpriteBatch {
+private:
+  struct Batch {
+    SDL_Texture *texture;
+    SDL_BlendMode blendMode;
+    float inverseWidth;
+    float inverseHeight;
+    int textureWidth;
+    int textureHeight;
+    std::vector<SDL_Vertex> vertices;
+  };
+
+  // Batches are kept across frames so their vertex buffers keep their
+  // capacity; the first batchCount are this frame's runs.
+  std::vector<Batch> batches;
+  unsigned int batchCount = 0;
+
+  // Every quad uses the same two triangles, so one shared index buffer
+  // serves all batches.
+  std::vector<int> indices;
+
+  unsigned int drawCallCount = 0;
+  unsigned int quadCount = 0;
+
+  Batch &CurrentBatch(SDL_Texture *texture, SDL_BlendMode blendMode);
+  void QueryTextureSize(Batch &batch);
+
+public:
+  SpriteBatch() = default;
+  ~SpriteBatch() = default;
+
+  void Begin();
+  void Draw(SDL_Texture *texture, const SDL_Rect &srcRect,
+            const SDL_FRect &dstRect, double rotation, SDL_Color color,
+            SDL_BlendMode blendMode);
+  void Flush(SDL_Renderer *renderer);
+
+  unsigned int GetDrawCallCount() const { return drawCallCount; }
+  unsigned int GetQuadCount() const { return quadCount; }
+};
+
+#endif
@@ -0,0 +1,237 @@
+#include "TextureAtlas.h"
+#include <SDL2/SDL_image.h>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <spdlog/spdlog.h>
+
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <imgui/imstb_rectpack.h>
+
+TextureAtlas::~TextureAtlas() { FreeSurfaces(); }
+
+void
+TextureAtlas::FreeSurfaces() {
+  for (auto surface : pageSurfaces) {
+    SDL_FreeSurface(surface);
+  }
+  pageSurfaces.clear();
+}
+
+void
+TextureAtlas::Clear() {
+  FreeSurfaces();
+  if (assetStore) {
+    for (auto page : pages) {
+      assetStore->Release(page);
+    }
+  }
+  pages.clear();
+  pageFiles.clear();
+  regions.clear();
+}
+
+bool
+TextureAtlas::Pack(const std::string &imageDirectory, int pageSize) {
+  Clear();
+  atlasName = std::filesystem::path(imageDirectory).filename().string();
+
+  std::vector<std::string> names;
+  std::vector<SDL_Surface *> images;
+  for (const auto &file : std::filesystem::directory_iterator(imageDirectory)) {
+    if (file.path().extension() != ".png") {
+      continue;
+    }
+
+    SDL_Surface *loaded = IMG_Load(file.path().c_str());
+    if (!loaded) {
+      spdlog::error("Error loading atlas image " + file.path().string() + ": " +
+                    IMG_GetError());
+      continue;
+    }
+
+    SDL_Surface *converted =
+        SDL_ConvertSurfaceFormat(loaded, SDL_PIXELFORMAT_RGBA32, 0);
+    SDL_FreeSurface(loaded);
+    if (!converted) {
+      spdlog::error("Error converting atlas image " + file.path().string() +
+                    ": " + SDL_GetError());
+      continue;
+    }
+
+    images.push_back(converted);
+    names.push_back(file.path().stem().string());
+  }
+
+  std::vector<stbrp_rect> pending;
+  for (unsigned int i = 0; i < images.size(); i++) {
+    stbrp_rect rect = {};
+    rect.id = i;
+    rect.w = images[i]->w + 2 * ATLAS_PADDING;
+    rect.h = images[i]->h + 2 * ATLAS_PADDING;
+
+    if (rect.w > pageSize || rect.h > pageSize) {
+      spdlog::error("Atlas image " + names[i] + " does not fit in a page");
+      continue;
+    }
+    pending.push_back(rect);
+  }
+
+  std::vector<stbrp_node> nodes(pageSize);
+  while (!pending.empty()) {
+    stbrp_context context;
+    stbrp_init_target(&context, pageSize, pageSize, nodes.data(), nodes.size());
+    stbrp_pack_rects(&context, pending.data(), pending.size());
+
+    const unsigned int page = pageSurfaces.size();
+    SDL_Surface *pageSurface = SDL_CreateRGBSurfaceWithFormat(
+        0, pageSize, pageSize, 32, SDL_PIXELFORMAT_RGBA32);
+    pageSurfaces.push_back(pageSurface);
+
+    for (const auto &rect : pending) {
+      if (!rect.was_packed) {
+        continue;
+      }
+
+      SDL_Surface *image = images[rect.id];
+      SDL_Rect destination = {rect.x + ATLAS_PADDING, rect.y + ATLAS_PADDING,
+                              image->w, image->h};
+      SDL_SetSurfaceBlendMode(image, SDL_BLENDMODE_NONE);
+      SDL_BlitSurface(image, nullptr, pageSurface, &destination);
+
+      regions[names[rect.id]] = {AssetHandle(), page, destination};
+    }
+
+    pending.erase(std::remove_if(pending.begin(), pending.end(),
+                                 [](const stbrp_rect &rect) {
+                                   return rect.was_packed;
+                                 }),
+                  pending.end());
+  }
+
+  for (auto image : images) {
+    SDL_FreeSurface(image);
+  }
+
+  spdlog::info("Packed " + std::to_string(regions.size()) + " images into " +
+               std::to_string(pageSurfaces.size()) + " atlas pages");
+  return !regions.empty();
+}
+
+// Table format: one "page <index> <file>" line per page, then one
+// "<name> <page> <x> <y> <w> <h>" line per region.
+bool
+TextureAtlas::Save(const std::string &outputPrefix) const {
+  std::ofstream table(outputPrefix + ".atlas");
+  if (!table) {
+    spdlog::error("Error writing atlas table " + outputPrefix + ".atlas");
+    return false;
+  }
+
+  const auto prefixName = std::filesystem::path(outputPrefix).filename();
+  for (unsigned int page = 0; page < pageSurfaces.size(); page++) {
+    const std::string file =
+        prefixName.string() + "-" + std::to_string(page) + ".png";
+    const auto path = std::filesystem::path(outputPrefix).parent_path() / file;
+
+    if (IMG_SavePNG(pageSurfaces[page], path.c_str()) != 0) {
+      spdlog::error("Error writing atlas page " + path.string() + ": " +
+                    IMG_GetError());
+      return false;
+    }
+    table << "page " << page << " " << file << "\n";
+  }
+
+  for (const auto &region : regions) {
+    const auto &rect = region.second.rect;
+    table << region.first << " " << region.second.page << " " << rect.x << " "
+          << rect.y << " " << rect.w << " " << rect.h << "\n";
+  }
+
+  return true;
+}
+
+bool
+TextureAtlas::Load(const std::string &atlasPrefix) {
+  Clear();
+
+  std::ifstream table(atlasPrefix + ".atlas");
+  if (!table) {
+    return false;
+  }
+
+  atlasName = std::filesystem::path(atlasPrefix).filename().string();
+  const auto directory = std::filesystem::path(atlasPrefix).parent_path();
+  std::string regionName;
+  while (table >> regionName) {
+    if (regionName == "page") {
+      unsigned int page;
+      std::string file;
+      table >> page >> file;
+
+      if (page >= pageFiles.size()) {
+        pageFiles.resize(page + 1);
+      }
+      pageFiles[page] = (directory / file).string();
+      continue;
+    }
+
+    AtlasRegion region = {AssetHandle(), 0, {0, 0, 0, 0}};
+    table >> region.page >> region.rect.x >> region.rect.y >> region.rect.w >>
+        region.rect.h;
+    regions[regionName] = region;
+  }
+
+  return !pageFiles.empty();
+}
+
+// Hands the pages to the store: saved pages are decoded on its workers, packed
+// ones are queued straight for upload.
+bool
+TextureAtlas::Upload(AssetStore &assetStore) {
+  this->assetStore = &assetStore;
+
+  for (unsigned int page = 0; page < pageFiles.size(); page++) {
+    pages.push_back(assetStore.LoadTexture(
+        "atlas:" + atlasName + "-" + std::to_string(page), pageFiles[page]));
+  }
+  for (unsigned int page = 0; page < pageSurfaces.size(); page++) {
+    pages.push_back(assetStore.AddTexture(
+        "atlas:" + atlasName + "-" + std::to_string(page), pageSurfaces[page]));
+  }
+  pageSurfaces.clear();
+
+  for (auto &region : regions) {
+    region.second.texture = pages[region.second.page];
+  }
+  return !pages.empty();
+}
+
+// Called with a changed source image: only its region of the page texture is
+// decoded and re-uploaded. Returns false if the image is not in the atlas.
+bool
+TextureAtlas::Reload(const std::string &imagePath) {
+  const auto path = std::filesystem::path(imagePath);
+  if (!assetStore || path.extension() != ".png") {
+    return false;
+  }
+
+  const auto region = regions.find(path.stem().string());
+  if (region == regions.end()) {
+    return false;
+  }
+
+  assetStore->ReloadRegion(region->second.texture, region->second.rect,
+                           imagePath);
+  return true;
+}
+
+AtlasRegion
+TextureAtlas::GetRegion(const std::string &name) const {
+  const auto region = regions.find(name);
+  if (region == regions.end()) {
+    spdlog::error("Atlas region " + name + " not found");
+    return {AssetHandle(), 0, {0, 0, 0, 0}};
+  }
+  return region->second;
+}
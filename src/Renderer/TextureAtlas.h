@@ -0,0 +1,55 @@
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+#include "../AssetStore/AssetStore.h"
+#include <SDL2/SDL.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+const int ATLAS_PAGE_SIZE = 1024;
+const int ATLAS_PADDING = 1;
+
+struct AtlasRegion {
+  AssetHandle texture;
+  unsigned int page;
+  SDL_Rect rect;
+};
+
+// Packs every image of a directory into as few pages as possible, keyed by
+// file name without extension ("tank-panther-up"). The packer tool saves the
+// pages and a lookup table at build time; the game loads those, and packs in
+// memory only when they are missing. Pages are textures in the AssetStore.
+class TextureAtlas {
+private:
+  std::string atlasName;
+  AssetStore *assetStore = nullptr;
+
+  // A page is either a file found by Load or a surface built by Pack.
+  std::vector<std::string> pageFiles;
+  std::vector<SDL_Surface *> pageSurfaces;
+  std::vector<AssetHandle> pages;
+  std::unordered_map<std::string, AtlasRegion> regions;
+
+  void FreeSurfaces();
+
+public:
+  TextureAtlas() = default;
+  ~TextureAtlas();
+
+  bool Pack(const std::string &imageDirectory,
+            int pageSize = ATLAS_PAGE_SIZE);
+  bool Save(const std::string &outputPrefix) const;
+  bool Load(const std::string &atlasPrefix);
+  bool Upload(AssetStore &assetStore);
+  bool Reload(const std::string &imagePath);
+  void Clear();
+
+  AtlasRegion GetRegion(const std::string &name) const;
+  const std::unordered_map<std::string, AtlasRegion> &GetRegions() const {
+    return regions;
+  }
+  const std::vector<AssetHandle> &GetPages() const { return pages; }
+};
+
+#endif
@@ -0,0 +1,208 @@
+#ifndef ANIMATIONSYSTEM_H
+#define ANIMATIONSYSTEM_H
+
+#include "../Components/AnimationComponent.h"
+#include "../Components/SpriteComponent.h"
+#include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
+#include <SDL2/SDL.h>
+#include <cmath>
+#include <spdlog/spdlog.h>
+#include <vector>
+
+const unsigned int NO_FRAME = ~0u;
+const unsigned int INVALID_CLIP = ~0u; // plays nothing
+
+// Plays spritesheet clips. Clips are frame rectangles shared by every entity
+// playing them. Playback state is kept here as parallel arrays, one slot per
+// entity, so Update advances all animations in one pass without touching
+// the component pools; sprites are only written when their frame changes.
+class AnimationSystem : public System {
+private:
+  // Clips, indexed by clip id; their frames are stored back to back.
+  std::vector<SDL_Rect> frames;
+  std::vector<unsigned int> clipFirstFrame;
+  std::vector<unsigned int> clipFrameCount;
+  std::vector<float> clipFramesPerSecond;
+
+  // Playback, one slot per entity.
+  std::vector<Entity> slotEntities;
+  std::vector<unsigned int> clipIds;
+  std::vector<double> times;
+  std::vector<float> playbackRates;
+  std::vector<unsigned char> isLooping;
+  std::vector<unsigned int> currentFrames;
+  std::vector<unsigned int> nextFrames;
+  std::vector<unsigned int> slotOfEntity;
+
+  static constexpr unsigned int NO_SLOT = ~0u;
+
+  unsigned int FindSlot(Entity entity) const {
+    const auto id = entity.GetId();
+    return id < slotOfEntity.size() ? slotOfEntity[id] : NO_SLOT;
+  }
+
+public:
+  AnimationSystem() {
+    RequireComponent<AnimationComponent>();
+    RequireComponent<SpriteComponent>();
+  }
+  ~AnimationSystem() = default;
+
+  // Returns INVALID_CLIP unless framesPerSecond is positive; time within a
+  // clip is derived from its frame rate.
+  unsigned int AddClip(const std::vector<SDL_Rect> &clipFrames,
+                       float framesPerSecond) {
+    if (!(framesPerSecond > 0.0f) || !std::isfinite(framesPerSecond)) {
+      spdlog::error("Animation clip of " + std::to_string(clipFrames.size()) +
+                    " frames has an invalid rate of " +
+                    std::to_string(framesPerSecond) + " frames per second");
+      return INVALID_CLIP;
+    }
+    clipFirstFrame.push_back(frames.size());
+    clipFrameCount.push_back(clipFrames.size());
+    clipFramesPerSecond.push_back(framesPerSecond);
+    frames.insert(frames.end(), clipFrames.begin(), clipFrames.end());
+    return clipFirstFrame.size() - 1;
+  }
+
+  // Frames of a grid laid out left to right, top to bottom, starting at
+  // the sheet's top-left corner (an atlas region, say).
+  static std::vector<SDL_Rect> GridFrames(SDL_Rect sheet, int frameWidth,
+                                          int frameHeight, int firstFrame,
+                                          int frameCount) {
+    const int columns = sheet.w / frameWidth;
+    std::vector<SDL_Rect> gridFrames;
+    for (int frame = firstFrame; frame < firstFrame + frameCount; frame++) {
+      gridFrames.push_back({sheet.x + (frame % columns) * frameWidth,
+                            sheet.y + (frame / columns) * frameHeight,
+                            frameWidth, frameHeight});
+    }
+    return gridFrames;
+  }
+
+  void AddEntityToSystem(Entity entity) override {
+    System::AddEntityToSystem(entity);
+
+    const auto &animation = entity.GetComponent<AnimationComponent>();
+    const auto id = entity.GetId();
+    if (id >= slotOfEntity.size()) {
+      slotOfEntity.resize(id + 1, NO_SLOT);
+    }
+
+    slotOfEntity[id] = slotEntities.size();
+    slotEntities.push_back(entity);
+    clipIds.push_back(animation.clipId);
+    times.push_back(animation.frameTime);
+    playbackRates.push_back(animation.playbackRate);
+    isLooping.push_back(animation.isLooping);
+    currentFrames.push_back(NO_FRAME);
+    nextFrames.push_back(NO_FRAME);
+  }
+
+  // The last slot moves into the freed one.
+  void RemoveEntityFromSystem(Entity entity) override {
+    System::RemoveEntityFromSystem(entity);
+
+    const auto slot = FindSlot(entity);
+    if (slot == NO_SLOT) {
+      return;
+    }
+
+    const auto last = slotEntities.size() - 1;
+    slotEntities[slot] = slotEntities[last];
+    clipIds[slot] = clipIds[last];
+    times[slot] = times[last];
+    playbackRates[slot] = playbackRates[last];
+    isLooping[slot] = isLooping[last];
+    currentFrames[slot] = currentFrames[last];
+    nextFrames[slot] = nextFrames[last];
+    slotOfEntity[slotEntities[slot].GetId()] = slot;
+    slotOfEntity[entity.GetId()] = NO_SLOT;
+
+    slotEntities.pop_back();
+    clipIds.pop_back();
+    times.pop_back();
+    playbackRates.pop_back();
+    isLooping.pop_back();
+    currentFrames.pop_back();
+    nextFrames.pop_back();
+  }
+
+  void Play(Entity entity, unsigned int clipId, bool isLooping = true,
+            bool restart = true) {
+    const auto slot = FindSlot(entity);
+    if (slot == NO_SLOT || clipId >= clipFirstFrame.size()) {
+      return;
+    }
+
+    this->isLooping[slot] = isLooping;
+    if (clipIds[slot] != clipId || restart) {
+      clipIds[slot] = clipId;
+      times[slot] = 0.0;
+    }
+  }
+
+  void SetPlaybackRate(Entity entity, float playbackRate) {
+    const auto slot = FindSlot(entity);
+    if (slot != NO_SLOT) {
+      playbackRates[slot] = playbackRate;
+    }
+  }
+
+  // True once a clip that does not loop has shown its last frame.
+  bool IsFinished(Entity entity) const {
+    const auto slot = FindSlot(entity);
+    if (slot == NO_SLOT || isLooping[slot]) {
+      return false;
+    }
+    const auto clip = clipIds[slot];
+    if (clip >= clipFirstFrame.size()) {
+      return true; // an invalid clip has nothing left to show
+    }
+    return times[slot] * clipFramesPerSecond[clip] >= clipFrameCount[clip];
+  }
+
+  void Update(double deltaTime) {
+    PROFILE_SCOPE("AnimationSystem::Update");
+    const unsigned int count = slotEntities.size();
+    const unsigned int clipCount = clipFirstFrame.size();
+
+    for (unsigned int i = 0; i < count; i++) {
+      const unsigned int clip = clipIds[i];
+      if (clip >= clipCount || clipFrameCount[clip] == 0) {
+        nextFrames[i] = NO_FRAME;
+        continue;
+      }
+
+      const double frameCount = clipFrameCount[clip];
+      double frame =
+          (times[i] + deltaTime * playbackRates[i]) * clipFramesPerSecond[clip];
+      // Negative rates play backwards.
+      if ((frame >= frameCount || frame < 0.0) && isLooping[i]) {
+        frame -= frameCount * std::floor(frame / frameCount);
+      } else if (frame >= frameCount) {
+        frame = frameCount;
+      } else if (frame < 0.0) {
+        frame = 0.0;
+      }
+
+      times[i] = frame / clipFramesPerSecond[clip];
+      const unsigned int index = static_cast<unsigned int>(frame);
+      nextFrames[i] = clipFirstFrame[clip] +
+                      (index < clipFrameCount[clip] ? index
+                                                    : clipFrameCount[clip] - 1);
+    }
+
+    for (unsigned int i = 0; i < count; i++) {
+      if (nextFrames[i] == currentFrames[i] || nextFrames[i] == NO_FRAME) {
+        continue;
+      }
+      currentFrames[i] = nextFrames[i];
+      slotEntities[i].GetComponent<SpriteComponent>().srcRect =
+          frames[nextFrames[i]];
+    }
+  }
+};
+
+#endif
@@ -0,0 +1,216 @@
+#ifndef COLLISIONSYSTEM_H
+#define COLLISIONSYSTEM_H
+
+#include "../Components/BoxColliderComponent.h"
+#include "../Components/TransformComponent.h"
+#include "../ECS/ECS.h"
+#include "../Physics/Broadphase.h"
+#include "../Profiler/Profiler.h"
+#include <algorithm>
+#include <memory>
+#include <spdlog/spdlog.h>
+
+// timeOfImpact is the fraction of the frame's motion at which the boxes first
+// touch. Pairs without a fast mover are only tested at the end of the frame
+// and report 1.
+struct Collision {
+  unsigned int a;
+  unsigned int b;
+  float timeOfImpact;
+};
+
+class CollisionSystem : public System {
+private:
+  static constexpr unsigned int NOT_AWAKE = ~0u;
+
+  std::unique_ptr<IBroadphase> broadphase;
+
+  // Sleeping colliders move out of the broadphase into a tree that only
+  // awake proxies query, so they are neither refreshed nor paired with each
+  // other. Their cost is one leaf in a tree that does not change while they
+  // sleep.
+  std::unique_ptr<IBroadphase> sleepingBroadphase;
+  std::vector<Entity> awakeEntities;
+
+  // Indexed by entity id.
+  std::vector<AABB> boxes;
+  std::vector<AABB> previousBoxes;
+  std::vector<unsigned char> isFastMover;
+  std::vector<unsigned char> isInBroadphase;
+  std::vector<unsigned int> awakeIndex;
+
+  std::vector<BroadphasePair> candidates;
+  std::vector<unsigned int> sleepingHits;
+  std::vector<Collision> collisions;
+
+  void UpdateProxy(Entity entity) {
+    const auto &transform = entity.GetComponent<TransformComponent>();
+    const auto &collider = entity.GetComponent<BoxColliderComponent>();
+    const auto id = entity.GetId();
+
+    const glm::vec2 min = transform.position + collider.offset;
+    const glm::vec2 size =
+        glm::vec2(collider.width, collider.height) * transform.scale;
+    const AABB box(min, min + size);
+
+    const bool isNew = !isInBroadphase[id];
+    previousBoxes[id] = isNew ? box : boxes[id];
+    boxes[id] = box;
+    isFastMover[id] = collider.isFastMover;
+
+    // Fast movers enter the broadphase with the bounds of their whole
+    // sweep, so anything they pass through this frame becomes a candidate.
+    if (isNew) {
+      broadphase->Insert(id, GetBroadphaseBox(id));
+      isInBroadphase[id] = 1;
+    } else {
+      broadphase->Move(id, GetBroadphaseBox(id));
+    }
+  }
+
+  AABB GetBroadphaseBox(unsigned int id) const {
+    return isFastMover[id] ? AABB::Union(previousBoxes[id], boxes[id])
+                           : boxes[id];
+  }
+
+  // Adds the sleeping colliders an awake proxy may touch to the candidates.
+  void QuerySleeping(unsigned int id) {
+    sleepingHits.clear();
+    sleepingBroadphase->Query(GetBroadphaseBox(id), sleepingHits);
+    for (auto other : sleepingHits) {
+      candidates.push_back({std::min(id, other), std::max(id, other)});
+    }
+  }
+
+  void RemoveFromAwake(Entity entity) {
+    const auto id = entity.GetId();
+    const auto index = awakeIndex[id];
+    if (index == NOT_AWAKE) {
+      return;
+    }
+
+    awakeEntities[index] = awakeEntities.back();
+    awakeIndex[awakeEntities[index].GetId()] = index;
+    awakeEntities.pop_back();
+    awakeIndex[id] = NOT_AWAKE;
+  }
+
+public:
+  CollisionSystem(BroadphaseType type = BroadphaseType::SpatialHashGrid) {
+    RequireComponent<TransformComponent>();
+    RequireComponent<BoxColliderComponent>();
+
+    broadphase = CreateBroadphase(type);
+    sleepingBroadphase = CreateBroadphase(BroadphaseType::DynamicAABBTree);
+  }
+  ~CollisionSystem() = default;
+
+  void AddEntityToSystem(Entity entity) override {
+    System::AddEntityToSystem(entity);
+
+    const auto id = entity.GetId();
+    if (id >= awakeIndex.size()) {
+      boxes.resize(id + 1);
+      previousBoxes.resize(id + 1);
+      isFastMover.resize(id + 1, 0);
+      isInBroadphase.resize(id + 1, 0);
+      awakeIndex.resize(id + 1, NOT_AWAKE);
+    }
+
+    if (awakeIndex[id] == NOT_AWAKE) {
+      awakeIndex[id] = awakeEntities.size();
+      awakeEntities.push_back(entity);
+    }
+  }
+
+  void RemoveEntityFromSystem(Entity entity) override {
+    System::RemoveEntityFromSystem(entity);
+
+    const auto id = entity.GetId();
+    if (isInBroadphase[id]) {
+      if (awakeIndex[id] != NOT_AWAKE) {
+        broadphase->Remove(id);
+      } else {
+        sleepingBroadphase->Remove(id);
+      }
+      isInBroadphase[id] = 0;
+    }
+    RemoveFromAwake(entity);
+  }
+
+  // Swaps the backend, e.g. when a map is loaded.
+  void SetBroadphase(BroadphaseType type) {
+    broadphase = CreateBroadphase(type);
+    for (auto entity : awakeEntities) {
+      const auto id = entity.GetId();
+      if (isInBroadphase[id]) {
+        broadphase->Insert(id, GetBroadphaseBox(id));
+      }
+    }
+  }
+
+  void SetSleeping(Entity entity, bool isSleeping) {
+    const auto id = entity.GetId();
+    if (id >= awakeIndex.size()) {
+      return;
+    }
+
+    if (isSleeping) {
+      if (awakeIndex[id] != NOT_AWAKE) {
+        UpdateProxy(entity);
+        previousBoxes[id] = boxes[id];
+        broadphase->Remove(id);
+        sleepingBroadphase->Insert(id, boxes[id]);
+        RemoveFromAwake(entity);
+      }
+    } else if (awakeIndex[id] == NOT_AWAKE && isInBroadphase[id]) {
+      sleepingBroadphase->Remove(id);
+      broadphase->Insert(id, GetBroadphaseBox(id));
+      awakeIndex[id] = awakeEntities.size();
+      awakeEntities.push_back(entity);
+    }
+  }
+
+  const std::vector<Collision> &GetCollisions() const { return collisions; }
+
+  IBroadphase &GetBroadphase() const { return *broadphase; }
+
+  void Update(bool debug = false) {
+    PROFILE_SCOPE("CollisionSystem::Update");
+    for (auto entity : awakeEntities) {
+      UpdateProxy(entity);
+    }
+
+    candidates.clear();
+    broadphase->ComputePairs(candidates);
+    for (auto entity : awakeEntities) {
+      QuerySleeping(entity.GetId());
+    }
+
+    collisions.clear();
+    for (const auto &pair : candidates) {
+      float timeOfImpact = 1.0f;
+
+      if (isFastMover[pair.a] || isFastMover[pair.b]) {
+        const auto &startA = previousBoxes[pair.a];
+        const auto &startB = previousBoxes[pair.b];
+        if (!AABB::Sweep(startA, boxes[pair.a].min - startA.min, startB,
+                         boxes[pair.b].min - startB.min, timeOfImpact)) {
+          continue;
+        }
+      } else if (!boxes[pair.a].Overlaps(boxes[pair.b])) {
+        continue;
+      }
+
+      collisions.push_back({pair.a, pair.b, timeOfImpact});
+
+      if (debug) {
+        spdlog::info("entity id: " + std::to_string(pair.a) +
+                     " is colliding with entity id: " +
+                     std::to_string(pair.b));
+      }
+    }
+  }
+};
+
+#endif
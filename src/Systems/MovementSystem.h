@@ -4,9 +4,79 @@
 #include "../Components/RigidBodyComponent.h"
 #include "../Components/TransformComponent.h"
 #include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
+#include "CollisionSystem.h"
 #include <spdlog/spdlog.h>
 
+const float SLEEP_VELOCITY_THRESHOLD = 1.0f; // pixels per second
+const float TIME_TO_SLEEP = 0.5f;            // seconds below the threshold
+
+struct SleepTransition {
+  Entity entity;
+  bool isSleeping;
+};
+
+// Only awake bodies are integrated. A body whose island of touching bodies
+// has stayed below the velocity threshold for TIME_TO_SLEEP is put to sleep
+// and skipped until a contact, Wake or ApplyImpulse wakes it. Its collider
+// stays queryable, see CollisionSystem::SetSleeping.
 class MovementSystem : public System {
+private:
+  static constexpr unsigned int NOT_ACTIVE = ~0u;
+
+  std::vector<Entity> activeEntities;
+
+  // Indexed by entity id.
+  std::vector<unsigned int> activeIndex;
+  std::vector<unsigned char> isMember;
+  std::vector<unsigned int> islandParent;
+  std::vector<float> islandSleepTimer;
+
+  std::vector<SleepTransition> sleepTransitions;
+
+  float sleepVelocityThreshold = SLEEP_VELOCITY_THRESHOLD;
+  float timeToSleep = TIME_TO_SLEEP;
+
+  void Activate(Entity entity) {
+    const auto id = entity.GetId();
+    activeIndex[id] = activeEntities.size();
+    activeEntities.push_back(entity);
+  }
+
+  void Deactivate(Entity entity) {
+    const auto id = entity.GetId();
+    const auto index = activeIndex[id];
+    if (index == NOT_ACTIVE) {
+      return;
+    }
+
+    activeEntities[index] = activeEntities.back();
+    activeIndex[activeEntities[index].GetId()] = index;
+    activeEntities.pop_back();
+    activeIndex[id] = NOT_ACTIVE;
+  }
+
+  void Sleep(Entity entity) {
+    auto &rigidbody = entity.GetComponent<RigidBodyComponent>();
+    auto &transform = entity.GetComponent<TransformComponent>();
+
+    rigidbody.isSleeping = true;
+    rigidbody.velocity = glm::vec2(0, 0);
+    transform.previousPosition = transform.position;
+    transform.previousRotation = transform.rotation;
+
+    Deactivate(entity);
+    sleepTransitions.push_back({entity, true});
+  }
+
+  unsigned int FindIsland(unsigned int id) {
+    while (islandParent[id] != id) {
+      islandParent[id] = islandParent[islandParent[id]];
+      id = islandParent[id];
+    }
+    return id;
+  }
+
 public:
   MovementSystem() {
     RequireComponent<TransformComponent>();
@@ -14,14 +84,86 @@ public:
   }
   ~MovementSystem() = default;
 
+  void AddEntityToSystem(Entity entity) override {
+    System::AddEntityToSystem(entity);
+
+    const auto id = entity.GetId();
+    if (id >= activeIndex.size()) {
+      activeIndex.resize(id + 1, NOT_ACTIVE);
+      isMember.resize(id + 1, 0);
+      islandParent.resize(id + 1);
+      islandSleepTimer.resize(id + 1);
+    }
+
+    isMember[id] = 1;
+    if (entity.GetComponent<RigidBodyComponent>().isSleeping) {
+      sleepTransitions.push_back({entity, true});
+    } else {
+      Activate(entity);
+    }
+  }
+
+  void RemoveEntityFromSystem(Entity entity) override {
+    System::RemoveEntityFromSystem(entity);
+
+    Deactivate(entity);
+    isMember[entity.GetId()] = 0;
+  }
+
+  void SetSleepParameters(float velocityThreshold, float timeToSleep) {
+    this->sleepVelocityThreshold = velocityThreshold;
+    this->timeToSleep = timeToSleep;
+  }
+
+  const std::vector<Entity> &GetActiveEntities() const {
+    return activeEntities;
+  }
+
+  const std::vector<SleepTransition> &GetSleepTransitions() const {
+    return sleepTransitions;
+  }
+
+  void ClearSleepTransitions() { sleepTransitions.clear(); }
+
+  void Wake(Entity entity) {
+    auto &rigidbody = entity.GetComponent<RigidBodyComponent>();
+    if (!rigidbody.isSleeping) {
+      return;
+    }
+
+    rigidbody.isSleeping = false;
+    rigidbody.sleepTimer = 0;
+
+    Activate(entity);
+    sleepTransitions.push_back({entity, false});
+  }
+
+  void ApplyImpulse(Entity entity, glm::vec2 impulse) {
+    Wake(entity);
+    entity.GetComponent<RigidBodyComponent>().velocity += impulse;
+  }
+
   void Update(double deltaTime, bool debug = false) {
-    for (auto entity : GetSystemEntities()) {
+    PROFILE_SCOPE("MovementSystem::Update");
+    const float thresholdSquared =
+        sleepVelocityThreshold * sleepVelocityThreshold;
+
+    for (auto entity : activeEntities) {
       auto &transform = entity.GetComponent<TransformComponent>();
-      const auto rigidbody = entity.GetComponent<RigidBodyComponent>();
+      auto &rigidbody = entity.GetComponent<RigidBodyComponent>();
+
+      transform.previousPosition = transform.position;
+      transform.previousRotation = transform.rotation;
 
       transform.position.x += rigidbody.velocity.x * deltaTime;
       transform.position.y += rigidbody.velocity.y * deltaTime;
 
+      if (glm::dot(rigidbody.velocity, rigidbody.velocity) <= thresholdSquared) {
+        rigidbody.sleepTimer += deltaTime;
+      } else {
+        rigidbody.sleepTimer = 0;
+      }
+
       if (debug) {
         spdlog::info(
             "entity id: " + std::to_string(entity.GetId()) +
@@ -30,6 +172,64 @@ public:
       }
     }
   }
+
+  // Groups awake bodies into islands through this tick's contacts and puts
+  // whole islands to sleep, so a resting body is never frozen while
+  // something is still pushing against it. A moving body touching a sleeping
+  // one wakes it.
+  void UpdateSleep(const std::vector<Collision> &collisions) {
+    PROFILE_SCOPE("MovementSystem::UpdateSleep");
+    for (const auto &collision : collisions) {
+      if (!isMember[collision.a] || !isMember[collision.b]) {
+        continue;
+      }
+
+      const bool isAwakeA = activeIndex[collision.a] != NOT_ACTIVE;
+      const bool isAwakeB = activeIndex[collision.b] != NOT_ACTIVE;
+      if (isAwakeA == isAwakeB) {
+        continue;
+      }
+
+      const auto awake = isAwakeA ? collision.a : collision.b;
+      const auto sleeping = isAwakeA ? collision.b : collision.a;
+      const auto &awakeEntity = activeEntities[activeIndex[awake]];
+      if (awakeEntity.GetComponent<RigidBodyComponent>().sleepTimer <
+          timeToSleep) {
+        Entity entity(sleeping);
+        entity.registry = awakeEntity.registry;
+        Wake(entity);
+      }
+    }
+
+    for (auto entity : activeEntities) {
+      const auto id = entity.GetId();
+      islandParent[id] = id;
+      islandSleepTimer[id] = entity.GetComponent<RigidBodyComponent>().sleepTimer;
+    }
+
+    for (const auto &collision : collisions) {
+      if (!isMember[collision.a] || !isMember[collision.b] ||
+          activeIndex[collision.a] == NOT_ACTIVE ||
+          activeIndex[collision.b] == NOT_ACTIVE) {
+        continue;
+      }
+
+      const auto islandA = FindIsland(collision.a);
+      const auto islandB = FindIsland(collision.b);
+      if (islandA != islandB) {
+        islandParent[islandB] = islandA;
+        islandSleepTimer[islandA] =
+            std::min(islandSleepTimer[islandA], islandSleepTimer[islandB]);
+      }
+    }
+
+    for (unsigned int i = activeEntities.size(); i-- > 0;) {
+      const auto entity = activeEntities[i];
+      if (islandSleepTimer[FindIsland(entity.GetId())] >= timeToSleep) {
+        Sleep(entity);
+      }
+    }
+  }
 };
 
-#endif
\ No newline at end of file
+#endif
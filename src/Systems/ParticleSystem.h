@@ -0,0 +1,196 @@
+#ifndef PARTICLESYSTEM_H
+#define PARTICLESYSTEM_H
+
+#include "../AssetStore/AssetStore.h"
+#include "../Components/ParticleEmitterComponent.h"
+#include "../Components/TransformComponent.h"
+#include "../ECS/ECS.h"
+#include "../Particles/ParticlePool.h"
+#include "../Profiler/Profiler.h"
+#include "../Renderer/Camera.h"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+const unsigned int PARTICLE_POOL_CAPACITY = 65536; // live particles per effect
+const unsigned int PARTICLE_BATCH_SIZE = 16384; // quads per geometry call
+
+// Particles are not entities: each effect owns a ParticlePool, and only the
+// emitters are components. Update emits and advances every pool; Render
+// draws each pool with as few SDL_RenderGeometryRaw calls as its size allows,
+// straight from the pool's arrays.
+class ParticleSystem : public System {
+private:
+  std::vector<std::unique_ptr<ParticlePool>> pools;
+
+  // Scratch vertex data for one batch, kept across frames.
+  std::vector<float> positions;
+  std::vector<SDL_Color> colors;
+  std::vector<float> texCoords;
+  std::vector<int> indices;
+
+  unsigned int drawCallCount = 0;
+  unsigned int quadCount = 0;
+
+  void FillTexCoords(const ParticlePool &pool, SDL_Texture *texture,
+                     unsigned int quads) {
+    int width = 1;
+    int height = 1;
+    if (texture) {
+      SDL_QueryTexture(texture, nullptr, nullptr, &width, &height);
+    }
+
+    SDL_Rect source = pool.GetEffect().srcRect;
+    if (source.w == 0 || source.h == 0) {
+      source = {0, 0, width, height};
+    }
+
+    const float u0 = static_cast<float>(source.x) / width;
+    const float v0 = static_cast<float>(source.y) / height;
+    const float u1 = static_cast<float>(source.x + source.w) / width;
+    const float v1 = static_cast<float>(source.y + source.h) / height;
+    const float quad[8] = {u0, v0, u1, v0, u1, v1, u0, v1};
+
+    texCoords.resize(quads * 8);
+    for (unsigned int i = 0; i < quads; i++) {
+      std::copy(quad, quad + 8, texCoords.begin() + i * 8);
+    }
+  }
+
+public:
+  ParticleSystem() {
+    RequireComponent<TransformComponent>();
+    RequireComponent<ParticleEmitterComponent>();
+
+    positions.resize(PARTICLE_BATCH_SIZE * 8);
+    colors.resize(PARTICLE_BATCH_SIZE * 4);
+    for (unsigned int i = 0; i < PARTICLE_BATCH_SIZE; i++) {
+      const int base = i * 4;
+      indices.insert(indices.end(),
+                     {base, base + 1, base + 2, base + 2, base + 3, base});
+    }
+  }
+  ~ParticleSystem() = default;
+
+  unsigned int AddEffect(const ParticleEffect &effect,
+                         unsigned int capacity = PARTICLE_POOL_CAPACITY) {
+    pools.push_back(std::make_unique<ParticlePool>(effect, capacity));
+    return pools.size() - 1;
+  }
+
+  // One-off emission not tied to an emitter, such as an explosion.
+  unsigned int Burst(unsigned int effectId, glm::vec2 position,
+                     unsigned int count, glm::vec2 velocity = glm::vec2(0, 0)) {
+    if (effectId >= pools.size()) {
+      return 0;
+    }
+    return pools[effectId]->Emit(position, velocity, count);
+  }
+
+  void Clear() {
+    for (auto &pool : pools) {
+      pool->Clear();
+    }
+  }
+
+  const ParticlePool &GetPool(unsigned int effectId) const {
+    return *pools[effectId];
+  }
+
+  unsigned int GetParticleCount() const {
+    unsigned int count = 0;
+    for (const auto &pool : pools) {
+      count += pool->GetCount();
+    }
+    return count;
+  }
+
+  unsigned int GetDrawCallCount() const { return drawCallCount; }
+  unsigned int GetQuadCount() const { return quadCount; }
+
+  void Update(double deltaTime) {
+    PROFILE_SCOPE("ParticleSystem::Update");
+    for (auto entity : GetSystemEntities()) {
+      auto &emitter = entity.GetComponent<ParticleEmitterComponent>();
+      if (emitter.effectId >= pools.size()) {
+        continue;
+      }
+
+      const auto &transform = entity.GetComponent<TransformComponent>();
+      const glm::vec2 origin = transform.position + emitter.offset;
+      auto &pool = *pools[emitter.effectId];
+
+      if (emitter.burstCount > 0) {
+        pool.Emit(origin, glm::vec2(0, 0), emitter.burstCount);
+        emitter.burstCount = 0;
+      }
+
+      if (!emitter.isEmitting) {
+        emitter.emitAccumulator = 0.0f;
+        continue;
+      }
+
+      emitter.emitAccumulator += emitter.particlesPerSecond * deltaTime;
+      const auto count = static_cast<unsigned int>(emitter.emitAccumulator);
+      emitter.emitAccumulator -= count;
+      pool.Emit(origin, glm::vec2(0, 0), count);
+    }
+
+    for (auto &pool : pools) {
+      pool->Update(static_cast<float>(deltaTime));
+    }
+  }
+
+  void Render(SDL_Renderer *renderer, const Camera &camera,
+              const AssetStore &assetStore) {
+    PROFILE_SCOPE("ParticleSystem::Render");
+    drawCallCount = 0;
+    quadCount = 0;
+
+    for (const auto &pool : pools) {
+      if (pool->GetCount() == 0) {
+        continue;
+      }
+
+      const auto &effect = pool->GetEffect();
+      SDL_Texture *texture = nullptr;
+      if (effect.texture.IsValid()) {
+        texture = assetStore.GetTexture(effect.texture);
+        if (!texture && renderer) {
+          continue;
+        }
+      }
+
+      if (texture) {
+        SDL_SetTextureBlendMode(texture, effect.blendMode);
+      } else if (renderer) {
+        SDL_SetRenderDrawBlendMode(renderer, effect.blendMode);
+      }
+
+      FillTexCoords(*pool, texture, PARTICLE_BATCH_SIZE);
+
+      for (unsigned int first = 0; first < pool->GetCount();
+           first += PARTICLE_BATCH_SIZE) {
+        const unsigned int quads =
+            pool->WriteVertices(first, PARTICLE_BATCH_SIZE, camera,
+                                positions.data(), colors.data());
+        if (quads == 0) {
+          continue;
+        }
+
+        drawCallCount++;
+        quadCount += quads;
+        if (renderer) {
+          SDL_RenderGeometryRaw(renderer, texture, positions.data(),
+                                2 * sizeof(float), colors.data(),
+                                sizeof(SDL_Color), texCoords.data(),
+                                2 * sizeof(float), quads * 4, indices.data(),
+                                quads * 6, sizeof(int));
+        }
+      }
+    }
+  }
+};
+
+#endif
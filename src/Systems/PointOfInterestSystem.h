@@ -0,0 +1,19 @@
+#ifndef POINTOFINTERESTSYSTEM_H
+#define POINTOFINTERESTSYSTEM_H
+
+#include "../Components/PointOfInterestComponent.h"
+#include "../Components/TransformComponent.h"
+#include "../ECS/ECS.h"
+
+// Collects the entities streamed tilemaps stay resident around; see
+// TilemapSystem::Stream.
+class PointOfInterestSystem : public System {
+public:
+  PointOfInterestSystem() {
+    RequireComponent<TransformComponent>();
+    RequireComponent<PointOfInterestComponent>();
+  }
+  ~PointOfInterestSystem() = default;
+};
+
+#endif
@@ -1,13 +1,43 @@
 #ifndef RENDERSYSTEM_H
 #define RENDERSYSTEM_H
 
+#include "../AssetStore/AssetStore.h"
 #include "../Components/SpriteComponent.h"
 #include "../Components/TransformComponent.h"
 #include "../ECS/ECS.h"
+#include "../Physics/DynamicAABBTree.h"
+#include "../Profiler/Profiler.h"
+#include "../Renderer/Camera.h"
+#include "../Renderer/RenderQueue.h"
+#include "../Renderer/SpriteBatch.h"
 #include <SDL2/SDL.h>
+#include <algorithm>
 #include <spdlog/spdlog.h>
 
+// Sprites are indexed by the bounds they cover between the previous and the
+// current tick, so only those under the camera are drawn. Bounds change only
+// on a tick, so the index is refreshed from the fixed update for the bodies
+// that moved, see UpdateBounds, and a frame's cost follows the number of
+// visible sprites. Visible sprites go through a RenderQueue sorted by layer,
+// then by the screen y of their bottom edge, then by texture.
 class RenderSystem : public System {
+private:
+  DynamicAABBTree spatialIndex;
+  std::vector<unsigned char> isIndexed;
+  std::vector<unsigned int> visibleIds;
+  RenderQueue renderQueue;
+  SpriteBatch spriteBatch;
+
+  static AABB GetBounds(Entity entity) {
+    const auto &transform = entity.GetComponent<TransformComponent>();
+    const auto &sprite = entity.GetComponent<SpriteComponent>();
+
+    const glm::vec2 size(sprite.width, sprite.height);
+    return AABB(glm::min(transform.previousPosition, transform.position),
+                glm::max(transform.previousPosition, transform.position) +
+                    size);
+  }
+
 public:
   RenderSystem() {
     RequireComponent<TransformComponent>();
@@ -15,19 +45,111 @@ public:
   }
   ~RenderSystem() = default;
 
-  void Update(SDL_Renderer *renderer) {
-    for (auto entity : GetSystemEntities()) {
-      const auto transform = entity.GetComponent<TransformComponent>();
-      auto sprite = entity.GetComponent<SpriteComponent>();
+  void AddEntityToSystem(Entity entity) override {
+    System::AddEntityToSystem(entity);
+
+    const auto id = entity.GetId();
+    if (id >= isIndexed.size()) {
+      isIndexed.resize(id + 1, 0);
+    }
+    if (!isIndexed[id]) {
+      spatialIndex.Insert(id, GetBounds(entity));
+      isIndexed[id] = 1;
+    }
+  }
+
+  void RemoveEntityFromSystem(Entity entity) override {
+    System::RemoveEntityFromSystem(entity);
+
+    const auto id = entity.GetId();
+    if (id < isIndexed.size() && isIndexed[id]) {
+      spatialIndex.Remove(id);
+      isIndexed[id] = 0;
+    }
+  }
+
+  // Re-indexes a sprite after its transform or size changed. Entities
+  // without a sprite are ignored, so a physics system's list can be passed.
+  void UpdateBounds(Entity entity) {
+    const auto id = entity.GetId();
+    if (id < isIndexed.size() && isIndexed[id]) {
+      spatialIndex.Move(id, GetBounds(entity));
+    }
+  }
+
+  void UpdateBounds(const std::vector<Entity> &entities) {
+    PROFILE_SCOPE("RenderSystem::UpdateBounds");
+    for (auto entity : entities) {
+      UpdateBounds(entity);
+    }
+  }
+
+  const std::vector<unsigned int> &GetVisibleEntities() const {
+    return visibleIds;
+  }
+
+  const RenderQueue &GetRenderQueue() const { return renderQueue; }
+  const SpriteBatch &GetSpriteBatch() const { return spriteBatch; }
+
+  void Update(SDL_Renderer *renderer, const Camera &camera,
+              const AssetStore &assetStore, double interpolationAlpha = 1.0) {
+    PROFILE_SCOPE("RenderSystem::Update");
+    const auto &entities = GetSystemEntities();
+    if (entities.empty()) {
+      return;
+    }
+
+    visibleIds.clear();
+    spatialIndex.Query(camera.GetWorldBounds(), visibleIds);
+    std::sort(visibleIds.begin(), visibleIds.end());
+
+    renderQueue.Begin();
+
+    Registry *registry = entities.front().registry;
+    for (auto id : visibleIds) {
+      Entity entity(id);
+      entity.registry = registry;
+
+      const auto &transform = entity.GetComponent<TransformComponent>();
+      const auto &sprite = entity.GetComponent<SpriteComponent>();
+
+      // Sprites whose texture is still loading are skipped rather than drawn
+      // as placeholders. Without a renderer textures never load, so every
+      // sprite is counted.
+      SDL_Texture *texture = nullptr;
+      if (sprite.texture.IsValid()) {
+        texture = assetStore.GetTexture(sprite.texture);
+        if (!texture && renderer) {
+          continue;
+        }
+      }
+
+      const glm::vec2 position = camera.WorldToScreen(
+          transform.InterpolatedPosition(interpolationAlpha));
+
+      const SDL_FRect dstRect = {position.x, position.y,
+                                 sprite.width * camera.zoom,
+                                 sprite.height * camera.zoom};
+
+      const auto key = RenderQueue::MakeKey(
+          sprite.zIndex, dstRect.y + dstRect.h,
+          sprite.texture.IsValid() ? sprite.texture.index + 1 : 0,
+          sprite.blendMode);
+      renderQueue.Push(key, {texture, sprite.srcRect, dstRect,
+                             transform.InterpolatedRotation(interpolationAlpha),
+                             sprite.color, sprite.blendMode});
+    }
 
-      SDL_Rect objRect = {static_cast<int>(transform.position.x),
-                          static_cast<int>(transform.position.y), sprite.width,
-                          sprite.height};
+    renderQueue.Sort();
 
-      SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-      SDL_RenderFillRect(renderer, &objRect);
+    spriteBatch.Begin();
+    for (unsigned int i = 0; i < renderQueue.GetCount(); i++) {
+      const auto &item = renderQueue.GetSorted(i);
+      spriteBatch.Draw(item.texture, item.srcRect, item.dstRect, item.rotation,
+                       item.color, item.blendMode);
     }
+    spriteBatch.Flush(renderer);
   }
 };
 
-#endif
\ No newline at end of file
+#endif
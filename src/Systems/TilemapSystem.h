@@ -0,0 +1,331 @@
+#ifndef TILEMAPSYSTEM_H
+#define TILEMAPSYSTEM_H
+
+#include "../AssetStore/AssetStore.h"
+#include "../Components/PointOfInterestComponent.h"
+#include "../Components/TilemapComponent.h"
+#include "../Components/TransformComponent.h"
+#include "../ECS/ECS.h"
+#include "../Profiler/Profiler.h"
+#include "../Renderer/Camera.h"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <memory>
+#include <spdlog/spdlog.h>
+#include <unordered_map>
+#include <vector>
+
+const size_t TILEMAP_TEXTURE_BUDGET = 64 * 1024 * 1024; // chunk texture bytes
+
+// Draws tilemaps chunk by chunk, using the map's own storage chunks. A chunk
+// is rendered tile by tile, every layer in order, into its own target texture
+// the first time it comes into view; after that, drawing the map is one copy
+// per chunk under the camera.
+//
+// Streamed maps are asked each tick for the chunks around the view and
+// around every point of interest, see Stream. Chunk textures are dropped
+// least recently drawn first once they exceed TILEMAP_TEXTURE_BUDGET.
+class TilemapSystem : public System {
+private:
+  struct ChunkCache {
+    std::shared_ptr<const Tilemap> tilemap;
+    SDL_Texture *tileset = nullptr;
+    unsigned int tilesetRevision = 0;
+    int columns = 0;
+    int rows = 0;
+    std::vector<SDL_Texture *> chunks;
+    std::vector<unsigned int> lastDrawn;
+    std::vector<unsigned int> renderedChunks;
+    size_t textureBytes = 0;
+  };
+
+  std::unordered_map<int, ChunkCache> caches;
+  std::vector<ChunkArea> streamingAreas;
+  unsigned int frame = 0;
+  unsigned int chunkRenderCount = 0;
+  unsigned int chunkDrawCount = 0;
+
+  // The chunk under a world position, which may lie outside the map.
+  static glm::ivec2 ChunkAt(const TransformComponent &transform,
+                            const TilemapComponent &tilemap, glm::vec2 world) {
+    const glm::vec2 chunkSize =
+        glm::vec2(tilemap.tilemap->GetChunkSize() * tilemap.tileSize) *
+        transform.scale;
+    return glm::ivec2(glm::floor((world - transform.position) / chunkSize));
+  }
+
+  static void FreeChunks(ChunkCache &cache) {
+    for (auto index : cache.renderedChunks) {
+      SDL_DestroyTexture(cache.chunks[index]);
+      cache.chunks[index] = nullptr;
+    }
+    cache.renderedChunks.clear();
+    cache.textureBytes = 0;
+  }
+
+  void EvictTextures(ChunkCache &cache, size_t chunkBytes) {
+    if (cache.textureBytes <= TILEMAP_TEXTURE_BUDGET) {
+      return;
+    }
+
+    std::sort(cache.renderedChunks.begin(), cache.renderedChunks.end(),
+              [&cache](unsigned int a, unsigned int b) {
+                return cache.lastDrawn[a] > cache.lastDrawn[b];
+              });
+    while (cache.textureBytes > TILEMAP_TEXTURE_BUDGET &&
+           cache.lastDrawn[cache.renderedChunks.back()] != frame) {
+      const auto index = cache.renderedChunks.back();
+      SDL_DestroyTexture(cache.chunks[index]);
+      cache.chunks[index] = nullptr;
+      cache.renderedChunks.pop_back();
+      cache.textureBytes -= chunkBytes;
+    }
+  }
+
+  SDL_Texture *RenderChunk(SDL_Renderer *renderer,
+                           const TilemapComponent &tilemap,
+                           SDL_Texture *tileset, int chunkX, int chunkY) {
+    const auto &map = *tilemap.tilemap;
+    if (!map.GetChunk(chunkX, chunkY)) {
+      return nullptr; // still streaming in
+    }
+
+    const int chunkSize = map.GetChunkSize();
+    const int firstX = chunkX * chunkSize;
+    const int firstY = chunkY * chunkSize;
+    const int tilesX = std::min(chunkSize, map.GetWidth() - firstX);
+    const int tilesY = std::min(chunkSize, map.GetHeight() - firstY);
+
+    SDL_Texture *chunk = SDL_CreateTexture(
+        renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+        tilesX * tilemap.tileSize, tilesY * tilemap.tileSize);
+    if (!chunk) {
+      spdlog::error(std::string("Error creating tilemap chunk texture: ") +
+                    SDL_GetError());
+      return nullptr;
+    }
+    SDL_SetTextureBlendMode(chunk, SDL_BLENDMODE_BLEND);
+
+    int tilesetWidth = 0;
+    SDL_QueryTexture(tileset, nullptr, nullptr, &tilesetWidth, nullptr);
+    const int tilesetColumns = std::max(1, tilesetWidth / tilemap.tileSize);
+
+    SDL_Texture *previousTarget = SDL_GetRenderTarget(renderer);
+    SDL_SetRenderTarget(renderer, chunk);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+
+    for (int layer = 0; layer < map.GetLayerCount(); layer++) {
+      for (int y = 0; y < tilesY; y++) {
+        for (int x = 0; x < tilesX; x++) {
+          const uint16_t tile = map.GetTile(firstX + x, firstY + y, layer);
+          if (tile == EMPTY_TILE) {
+            continue;
+          }
+
+          const SDL_Rect srcRect = {
+              (tile % tilesetColumns) * tilemap.tileSize,
+              (tile / tilesetColumns) * tilemap.tileSize, tilemap.tileSize,
+              tilemap.tileSize};
+          const SDL_Rect dstRect = {x * tilemap.tileSize,
+                                    y * tilemap.tileSize, tilemap.tileSize,
+                                    tilemap.tileSize};
+          SDL_RenderCopy(renderer, tileset, &srcRect, &dstRect);
+        }
+      }
+    }
+
+    SDL_SetRenderTarget(renderer, previousTarget);
+    chunkRenderCount++;
+    return chunk;
+  }
+
+public:
+  TilemapSystem() {
+    RequireComponent<TransformComponent>();
+    RequireComponent<TilemapComponent>();
+  }
+  ~TilemapSystem() = default;
+
+  void RemoveEntityFromSystem(Entity entity) override {
+    System::RemoveEntityFromSystem(entity);
+
+    const auto cache = caches.find(entity.GetId());
+    if (cache != caches.end()) {
+      FreeChunks(cache->second);
+      caches.erase(cache);
+    }
+  }
+
+  // Drops every cached chunk so it is rendered again when next in view, for
+  // when the renderer loses its render targets.
+  void Invalidate() {
+    for (auto &cache : caches) {
+      FreeChunks(cache.second);
+    }
+  }
+
+  // Textures belong to the renderer, so this must run before it is
+  // destroyed.
+  void Clear() {
+    Invalidate();
+    caches.clear();
+  }
+
+  // Asks streamed maps for the chunks around the view and around the
+  // entities of a PointOfInterestSystem. Call it from the fixed update, so
+  // maps stream in around simulated entities even when nothing is drawn;
+  // Update only draws the chunks already resident.
+  void Stream(const Camera &camera,
+              const std::vector<Entity> &pointsOfInterest) {
+    PROFILE_SCOPE("TilemapSystem::Stream");
+    const AABB view = camera.GetWorldBounds();
+    for (auto entity : GetSystemEntities()) {
+      const auto &transform = entity.GetComponent<TransformComponent>();
+      const auto &tilemap = entity.GetComponent<TilemapComponent>();
+      if (!tilemap.tilemap || !tilemap.tilemap->IsStreaming()) {
+        continue;
+      }
+
+      const glm::ivec2 first = ChunkAt(transform, tilemap, view.min);
+      const glm::ivec2 last = ChunkAt(transform, tilemap, view.max);
+      streamingAreas.clear();
+      streamingAreas.push_back({first.x, first.y, last.x, last.y});
+      streamingAreas.push_back({first.x - TILEMAP_STREAMING_RADIUS,
+                                first.y - TILEMAP_STREAMING_RADIUS,
+                                last.x + TILEMAP_STREAMING_RADIUS,
+                                last.y + TILEMAP_STREAMING_RADIUS});
+      for (auto point : pointsOfInterest) {
+        const auto &pointTransform = point.GetComponent<TransformComponent>();
+        const auto &pointOfInterest =
+            point.GetComponent<PointOfInterestComponent>();
+        const auto radius = pointOfInterest.radius;
+        const glm::ivec2 chunk =
+            ChunkAt(transform, tilemap, pointTransform.position);
+        streamingAreas.push_back({chunk.x - radius, chunk.y - radius,
+                                  chunk.x + radius, chunk.y + radius});
+      }
+      tilemap.tilemap->Stream(streamingAreas);
+    }
+  }
+
+  // Loads a changed map file again for every tilemap using it.
+  bool Reload(const std::string &filePath) {
+    const auto path = std::filesystem::path(filePath).lexically_normal();
+
+    bool isFound = false;
+    for (auto entity : GetSystemEntities()) {
+      auto &tilemap = entity.GetComponent<TilemapComponent>();
+      if (!tilemap.tilemap ||
+          std::filesystem::path(tilemap.tilemap->GetFilePath())
+                  .lexically_normal() != path) {
+        continue;
+      }
+
+      auto reloaded = std::make_shared<Tilemap>();
+      if (tilemap.tilemap->IsStreaming() ? reloaded->OpenStreaming(filePath)
+                                         : reloaded->Load(filePath)) {
+        tilemap.tilemap = reloaded;
+        spdlog::info("Reloaded tilemap " + filePath);
+      }
+      isFound = true;
+    }
+    return isFound;
+  }
+
+  unsigned int GetChunkRenderCount() const { return chunkRenderCount; }
+  unsigned int GetChunkDrawCount() const { return chunkDrawCount; }
+
+  size_t GetTextureBytes() const {
+    size_t bytes = 0;
+    for (const auto &cache : caches) {
+      bytes += cache.second.textureBytes;
+    }
+    return bytes;
+  }
+
+  void Update(SDL_Renderer *renderer, const Camera &camera,
+              const AssetStore &assetStore) {
+    PROFILE_SCOPE("TilemapSystem::Update");
+    chunkRenderCount = 0;
+    chunkDrawCount = 0;
+    frame++;
+
+    const AABB view = camera.GetWorldBounds();
+    for (auto entity : GetSystemEntities()) {
+      const auto &transform = entity.GetComponent<TransformComponent>();
+      const auto &tilemap = entity.GetComponent<TilemapComponent>();
+      if (!tilemap.tilemap) {
+        continue;
+      }
+
+      auto &map = *tilemap.tilemap;
+      const glm::vec2 chunkSize =
+          glm::vec2(map.GetChunkSize() * tilemap.tileSize) * transform.scale;
+
+      // The range of chunks under the camera comes straight from the view
+      // bounds, so maps of any size cost nothing outside of it.
+      const glm::ivec2 first = ChunkAt(transform, tilemap, view.min);
+      const glm::ivec2 last = ChunkAt(transform, tilemap, view.max);
+      const ChunkArea visible = {
+          std::max(0, first.x), std::max(0, first.y),
+          std::min(map.GetChunkColumns() - 1, last.x),
+          std::min(map.GetChunkRows() - 1, last.y)};
+
+      SDL_Texture *tileset = assetStore.GetTexture(tilemap.tileset);
+      if (!tileset) {
+        continue;
+      }
+
+      // A new map or a reloaded tileset makes every cached chunk stale.
+      const auto tilesetRevision = assetStore.GetRevision(tilemap.tileset);
+      auto &cache = caches[entity.GetId()];
+      if (cache.tilemap != tilemap.tilemap || cache.tileset != tileset ||
+          cache.tilesetRevision != tilesetRevision) {
+        FreeChunks(cache);
+        cache.tilemap = tilemap.tilemap;
+        cache.tileset = tileset;
+        cache.tilesetRevision = tilesetRevision;
+        cache.columns = map.GetChunkColumns();
+        cache.rows = map.GetChunkRows();
+        cache.chunks.assign(cache.columns * cache.rows, nullptr);
+        cache.lastDrawn.assign(cache.columns * cache.rows, 0);
+      }
+
+      for (int y = visible.firstY; y <= visible.lastY; y++) {
+        for (int x = visible.firstX; x <= visible.lastX; x++) {
+          const unsigned int index = y * cache.columns + x;
+          auto &chunk = cache.chunks[index];
+          if (!chunk) {
+            chunk = RenderChunk(renderer, tilemap, tileset, x, y);
+            if (!chunk) {
+              continue;
+            }
+            cache.renderedChunks.push_back(index);
+            cache.textureBytes += map.GetChunkSize() * map.GetChunkSize() *
+                                  tilemap.tileSize * tilemap.tileSize * 4;
+          }
+          cache.lastDrawn[index] = frame;
+
+          int width, height;
+          SDL_QueryTexture(chunk, nullptr, nullptr, &width, &height);
+          const glm::vec2 position = camera.WorldToScreen(
+              transform.position + glm::vec2(x, y) * chunkSize);
+          const SDL_FRect dstRect = {
+              position.x, position.y,
+              width * transform.scale.x * camera.zoom,
+              height * transform.scale.y * camera.zoom};
+          SDL_RenderCopyF(renderer, chunk, nullptr, &dstRect);
+          chunkDrawCount++;
+        }
+      }
+
+      EvictTextures(cache, map.GetChunkSize() * map.GetChunkSize() *
+                               tilemap.tileSize * tilemap.tileSize * 4);
+    }
+  }
+};
+
+#endif
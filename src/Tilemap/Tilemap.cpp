@@ -0,0 +1,534 @@
+#include "Tilemap.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <spdlog/spdlog.h>
+
+#ifdef __unix__
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+Tilemap::~Tilemap() { Reset(); }
+
+void
+Tilemap::Reset() {
+  if (loader.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      isStopping = true;
+    }
+    jobAvailable.notify_all();
+    loader.join();
+  }
+  isStopping = false;
+  jobs.clear();
+  loaded.clear();
+  isStreaming = false;
+  streamedChunks.clear();
+  residentChunks.clear();
+  streamFrame = 0;
+
+#ifdef __unix__
+  if (mapping) {
+    munmap(mapping, mappingSize);
+  }
+#endif
+  mapping = nullptr;
+  mappingSize = 0;
+  ownedChunks.clear();
+  chunks = nullptr;
+  filePath.clear();
+  width = 0;
+  height = 0;
+  layerCount = 0;
+  chunkColumns = 0;
+  chunkRows = 0;
+  hasCollision = false;
+  chunkStride = 0;
+}
+
+void
+Tilemap::SetLayout(int width, int height, int layerCount, int chunkSize,
+                   bool hasCollision) {
+  this->width = width;
+  this->height = height;
+  this->layerCount = layerCount;
+  this->chunkSize = chunkSize;
+  this->hasCollision = hasCollision;
+  chunkColumns = (width + chunkSize - 1) / chunkSize;
+  chunkRows = (height + chunkSize - 1) / chunkSize;
+
+  // Blocks stay 2-byte aligned so tile ids can be read in place.
+  const size_t tiles = static_cast<size_t>(chunkSize) * chunkSize;
+  chunkStride = layerCount * tiles * 2 + (hasCollision ? (tiles + 7) / 8 : 0);
+  chunkStride = (chunkStride + 1) & ~static_cast<size_t>(1);
+}
+
+// Checks a .tmap header before its fields are used to compute the layout.
+static bool
+IsValidHeader(const TilemapHeader &header, const std::string &filePath) {
+  if (std::memcmp(header.magic, "TMAP", 4) != 0 ||
+      header.version != TILEMAP_VERSION) {
+    spdlog::error("Tilemap " + filePath + " is not a version " +
+                  std::to_string(TILEMAP_VERSION) + " tilemap");
+    return false;
+  }
+
+  if (header.width == 0 || header.width > TILEMAP_MAX_SIZE ||
+      header.height == 0 || header.height > TILEMAP_MAX_SIZE ||
+      header.layerCount == 0 || header.layerCount > TILEMAP_MAX_LAYERS ||
+      header.chunkSize == 0 || header.chunkSize > TILEMAP_MAX_CHUNK_SIZE) {
+    spdlog::error("Tilemap " + filePath + " has an invalid size: " +
+                  std::to_string(header.width) + "x" +
+                  std::to_string(header.height) + " tiles, " +
+                  std::to_string(header.layerCount) + " layers, chunks of " +
+                  std::to_string(header.chunkSize));
+    return false;
+  }
+  return true;
+}
+
+// Picks the format by extension: .tmap is binary, anything else CSV.
+bool
+Tilemap::Load(const std::string &filePath) {
+  if (std::filesystem::path(filePath).extension() == ".tmap") {
+    return LoadBinary(filePath);
+  }
+  return LoadCsv({filePath});
+}
+
+bool
+Tilemap::LoadBinary(const std::string &filePath) {
+  Reset();
+
+#ifdef __unix__
+  const int fd = open(filePath.c_str(), O_RDONLY);
+  if (fd < 0) {
+    spdlog::error("Error opening tilemap " + filePath);
+    return false;
+  }
+
+  struct stat status;
+  if (fstat(fd, &status) != 0 ||
+      static_cast<size_t>(status.st_size) < sizeof(TilemapHeader)) {
+    spdlog::error("Tilemap " + filePath + " is too small");
+    close(fd);
+    return false;
+  }
+
+  void *data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    spdlog::error("Error mapping tilemap " + filePath + ": " +
+                  std::strerror(errno));
+    return false;
+  }
+  mapping = data;
+  mappingSize = status.st_size;
+#else
+  std::ifstream file(filePath, std::ios::binary);
+  if (!file) {
+    spdlog::error("Error opening tilemap " + filePath);
+    return false;
+  }
+  ownedChunks.assign(std::istreambuf_iterator<char>(file),
+                     std::istreambuf_iterator<char>());
+  const void *data = ownedChunks.data();
+  const size_t size = ownedChunks.size();
+  if (size < sizeof(TilemapHeader)) {
+    spdlog::error("Tilemap " + filePath + " is too small");
+    Reset();
+    return false;
+  }
+#endif
+
+  TilemapHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  if (!IsValidHeader(header, filePath)) {
+    Reset();
+    return false;
+  }
+
+  SetLayout(header.width, header.height, header.layerCount, header.chunkSize,
+            header.flags & TILEMAP_HAS_COLLISION);
+  const size_t expectedSize =
+      sizeof(TilemapHeader) +
+      static_cast<size_t>(chunkColumns) * chunkRows * chunkStride;
+#ifdef __unix__
+  const size_t size = mappingSize;
+#endif
+  if (size < expectedSize) {
+    spdlog::error("Tilemap " + filePath + " is truncated");
+    Reset();
+    return false;
+  }
+
+  chunks = static_cast<const unsigned char *>(data) + sizeof(TilemapHeader);
+  this->filePath = filePath;
+  return true;
+}
+
+bool
+Tilemap::OpenStreaming(const std::string &filePath, size_t memoryBudget) {
+  Reset();
+
+  std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+  if (!file) {
+    spdlog::error("Error opening tilemap " + filePath);
+    return false;
+  }
+  const size_t size = file.tellg();
+  file.seekg(0);
+
+  TilemapHeader header;
+  if (size < sizeof(header) ||
+      !file.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+    spdlog::error("Tilemap " + filePath + " is too small");
+    return false;
+  }
+  if (!IsValidHeader(header, filePath)) {
+    return false;
+  }
+
+  SetLayout(header.width, header.height, header.layerCount, header.chunkSize,
+            header.flags & TILEMAP_HAS_COLLISION);
+  if (size < sizeof(TilemapHeader) + static_cast<size_t>(chunkColumns) *
+                                         chunkRows * chunkStride) {
+    spdlog::error("Tilemap " + filePath + " is truncated");
+    Reset();
+    return false;
+  }
+
+  isStreaming = true;
+  streamingBudget = memoryBudget;
+  streamedChunks.resize(static_cast<size_t>(chunkColumns) * chunkRows);
+  this->filePath = filePath;
+  loader = std::thread(&Tilemap::LoaderLoop, this, filePath);
+  return true;
+}
+
+// Reads one chunk block per job. The loader keeps its own stream, so the main
+// thread never waits on the disk.
+void
+Tilemap::LoaderLoop(std::string filePath) {
+  std::ifstream file(filePath, std::ios::binary);
+
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    jobAvailable.wait(lock, [this] { return isStopping || !jobs.empty(); });
+    if (isStopping) {
+      return;
+    }
+
+    const unsigned int index = jobs.front();
+    jobs.pop_front();
+    lock.unlock();
+
+    auto data = std::make_unique<unsigned char[]>(chunkStride);
+    file.seekg(sizeof(TilemapHeader) +
+               static_cast<size_t>(index) * chunkStride);
+    if (!file.read(reinterpret_cast<char *>(data.get()), chunkStride)) {
+      spdlog::error("Error reading chunk " + std::to_string(index) +
+                    " of tilemap " + filePath);
+      file.clear();
+      data.reset();
+    }
+
+    lock.lock();
+    loaded.push_back({index, std::move(data)});
+  }
+}
+
+void
+Tilemap::Stream(const std::vector<ChunkArea> &areas) {
+  if (!isStreaming) {
+    return;
+  }
+  streamFrame++;
+
+  std::vector<LoadedChunk> arrived;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    arrived.swap(loaded);
+  }
+  for (auto &chunk : arrived) {
+    auto &streamed = streamedChunks[chunk.index];
+    if (!chunk.data) {
+      // A failed read is tried again if the chunk is still wanted.
+      streamed.state = ChunkState::Unloaded;
+      continue;
+    }
+    streamed.data = std::move(chunk.data);
+    streamed.state = ChunkState::Resident;
+    residentChunks.push_back(chunk.index);
+  }
+
+  std::vector<unsigned int> requests;
+  for (const auto &area : areas) {
+    const int firstX = std::max(0, area.firstX);
+    const int firstY = std::max(0, area.firstY);
+    const int lastX = std::min(chunkColumns - 1, area.lastX);
+    const int lastY = std::min(chunkRows - 1, area.lastY);
+    for (int y = firstY; y <= lastY; y++) {
+      for (int x = firstX; x <= lastX; x++) {
+        const unsigned int index = y * chunkColumns + x;
+        auto &streamed = streamedChunks[index];
+        streamed.lastUsed = streamFrame;
+        if (streamed.state == ChunkState::Unloaded) {
+          streamed.state = ChunkState::Loading;
+          requests.push_back(index);
+        }
+      }
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Loads queued for chunks that went out of range are dropped.
+    for (auto job = jobs.begin(); job != jobs.end();) {
+      if (streamedChunks[*job].lastUsed != streamFrame) {
+        streamedChunks[*job].state = ChunkState::Unloaded;
+        job = jobs.erase(job);
+      } else {
+        job++;
+      }
+    }
+    jobs.insert(jobs.end(), requests.begin(), requests.end());
+  }
+  if (!requests.empty()) {
+    jobAvailable.notify_one();
+  }
+
+  EvictChunks();
+}
+
+// Drops the least recently used chunks until the resident ones fit the
+// budget. Chunks asked for this frame always stay, even over budget.
+void
+Tilemap::EvictChunks() {
+  if (residentChunks.size() * chunkStride <= streamingBudget) {
+    return;
+  }
+
+  std::sort(residentChunks.begin(), residentChunks.end(),
+            [this](unsigned int a, unsigned int b) {
+              return streamedChunks[a].lastUsed > streamedChunks[b].lastUsed;
+            });
+  while (residentChunks.size() * chunkStride > streamingBudget) {
+    auto &streamed = streamedChunks[residentChunks.back()];
+    if (streamed.lastUsed == streamFrame) {
+      break;
+    }
+    streamed.data.reset();
+    streamed.state = ChunkState::Unloaded;
+    residentChunks.pop_back();
+  }
+}
+
+bool
+Tilemap::ReadCsv(const std::string &filePath, std::vector<int> &cells,
+                 int &width, int &height) {
+  std::ifstream file(filePath);
+  if (!file) {
+    spdlog::error("Error opening tilemap " + filePath);
+    return false;
+  }
+
+  cells.clear();
+  width = 0;
+  height = 0;
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos) {
+      continue;
+    }
+
+    std::stringstream row(line);
+    std::string cell;
+    int columns = 0;
+    while (std::getline(row, cell, ',')) {
+      try {
+        cells.push_back(std::stoi(cell));
+      } catch (const std::exception &) {
+        spdlog::error("Tilemap " + filePath + " has an invalid tile id '" +
+                      cell + "'");
+        return false;
+      }
+      columns++;
+    }
+
+    if (height > 0 && columns != width) {
+      spdlog::error("Tilemap " + filePath + " row " + std::to_string(height) +
+                    " has " + std::to_string(columns) + " tiles, expected " +
+                    std::to_string(width));
+      return false;
+    }
+    width = columns;
+    height++;
+  }
+
+  if (cells.empty()) {
+    spdlog::error("Tilemap " + filePath + " is empty");
+    return false;
+  }
+  return true;
+}
+
+bool
+Tilemap::LoadCsv(const std::vector<std::string> &layerFiles,
+                 const std::string &collisionFile) {
+  Reset();
+  if (layerFiles.empty()) {
+    return false;
+  }
+  if (layerFiles.size() > TILEMAP_MAX_LAYERS) {
+    spdlog::error("Tilemap " + layerFiles.front() + " has " +
+                  std::to_string(layerFiles.size()) + " layers, at most " +
+                  std::to_string(TILEMAP_MAX_LAYERS) + " are supported");
+    return false;
+  }
+
+  std::vector<std::vector<int>> layers(layerFiles.size());
+  std::vector<int> collision;
+  int mapWidth = 0;
+  int mapHeight = 0;
+  for (unsigned int layer = 0; layer <= layerFiles.size(); layer++) {
+    const bool isCollision = layer == layerFiles.size();
+    if (isCollision && collisionFile.empty()) {
+      break;
+    }
+
+    const auto &file = isCollision ? collisionFile : layerFiles[layer];
+    int fileWidth, fileHeight;
+    if (!ReadCsv(file, isCollision ? collision : layers[layer], fileWidth,
+                 fileHeight)) {
+      return false;
+    }
+    if (layer > 0 && (fileWidth != mapWidth || fileHeight != mapHeight)) {
+      spdlog::error("Tilemap " + file + " is " + std::to_string(fileWidth) +
+                    "x" + std::to_string(fileHeight) + ", expected " +
+                    std::to_string(mapWidth) + "x" +
+                    std::to_string(mapHeight));
+      return false;
+    }
+    if (fileWidth == 0 || fileWidth > static_cast<int>(TILEMAP_MAX_SIZE) ||
+        fileHeight == 0 || fileHeight > static_cast<int>(TILEMAP_MAX_SIZE)) {
+      spdlog::error("Tilemap " + file + " is " + std::to_string(fileWidth) +
+                    "x" + std::to_string(fileHeight) + ", at most " +
+                    std::to_string(TILEMAP_MAX_SIZE) + " tiles per side");
+      return false;
+    }
+
+    // Ids are stored as u16 and EMPTY_TILE is reserved; negative ids are
+    // empty.
+    if (!isCollision) {
+      const auto &cells = layers[layer];
+      for (size_t i = 0; i < cells.size(); i++) {
+        if (cells[i] >= EMPTY_TILE) {
+          spdlog::error("Tilemap " + file + " row " +
+                        std::to_string(i / fileWidth) + " column " +
+                        std::to_string(i % fileWidth) + " has tile id " +
+                        std::to_string(cells[i]) + ", ids must be below " +
+                        std::to_string(EMPTY_TILE));
+          return false;
+        }
+      }
+    }
+    mapWidth = fileWidth;
+    mapHeight = fileHeight;
+  }
+
+  SetLayout(mapWidth, mapHeight, layers.size(), TILEMAP_CHUNK_SIZE,
+            !collision.empty());
+  ownedChunks.assign(static_cast<size_t>(chunkColumns) * chunkRows *
+                         chunkStride,
+                     0);
+
+  const size_t tilesPerLayer = static_cast<size_t>(chunkSize) * chunkSize;
+  for (int chunkY = 0; chunkY < chunkRows; chunkY++) {
+    for (int chunkX = 0; chunkX < chunkColumns; chunkX++) {
+      unsigned char *block =
+          ownedChunks.data() +
+          (static_cast<size_t>(chunkY) * chunkColumns + chunkX) * chunkStride;
+      auto tiles = reinterpret_cast<uint16_t *>(block);
+      unsigned char *bits = block + layers.size() * tilesPerLayer * 2;
+
+      for (unsigned int layer = 0; layer < layers.size(); layer++) {
+        for (int y = 0; y < chunkSize; y++) {
+          for (int x = 0; x < chunkSize; x++) {
+            const int mapX = chunkX * chunkSize + x;
+            const int mapY = chunkY * chunkSize + y;
+            const int bit = y * chunkSize + x;
+
+            uint16_t tile = EMPTY_TILE;
+            if (mapX < width && mapY < height) {
+              const int id = layers[layer][mapY * width + mapX];
+              tile = id < 0 ? EMPTY_TILE : static_cast<uint16_t>(id);
+
+              if (hasCollision && layer == 0 &&
+                  collision[mapY * width + mapX] != 0) {
+                bits[bit >> 3] |= 1 << (bit & 7);
+              }
+            }
+            tiles[layer * tilesPerLayer + bit] = tile;
+          }
+        }
+      }
+    }
+  }
+
+  chunks = ownedChunks.data();
+  filePath = layerFiles.front();
+  return true;
+}
+
+// Written to a temporary file and renamed into place: a running game may
+// have the old file mapped, and truncating it under the mapping would crash
+// it on the next read.
+bool
+Tilemap::SaveBinary(const std::string &filePath) const {
+  if (!chunks) {
+    return false;
+  }
+
+  const std::string temporaryPath = filePath + ".tmp";
+  {
+    std::ofstream file(temporaryPath, std::ios::binary);
+    if (!file) {
+      spdlog::error("Error writing tilemap " + temporaryPath);
+      return false;
+    }
+
+    TilemapHeader header = {};
+    std::memcpy(header.magic, "TMAP", 4);
+    header.version = TILEMAP_VERSION;
+    header.width = width;
+    header.height = height;
+    header.layerCount = layerCount;
+    header.chunkSize = chunkSize;
+    header.flags = hasCollision ? TILEMAP_HAS_COLLISION : 0;
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(chunks),
+               static_cast<size_t>(chunkColumns) * chunkRows * chunkStride);
+    if (!file.flush()) {
+      spdlog::error("Error writing tilemap " + temporaryPath);
+      return false;
+    }
+  }
+
+  std::error_code error;
+  std::filesystem::rename(temporaryPath, filePath, error);
+  if (error) {
+    spdlog::error("Error writing tilemap " + filePath + ": " +
+                  error.message());
+    return false;
+  }
+  return true;
+}
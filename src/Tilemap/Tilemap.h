@@ -0,0 +1,183 @@
+#ifndef TILEMAP_H
+#define TILEMAP_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+const uint16_t EMPTY_TILE = 0xFFFF;
+const int TILEMAP_CHUNK_SIZE = 16; // tiles per chunk side
+const uint32_t TILEMAP_VERSION = 1;
+const uint32_t TILEMAP_HAS_COLLISION = 1;
+const size_t TILEMAP_STREAMING_BUDGET = 32 * 1024 * 1024; // tile bytes
+const int TILEMAP_STREAMING_RADIUS = 2; // chunks kept around the view
+
+// Largest header fields a .tmap may have, so its layout fits in int.
+const uint32_t TILEMAP_MAX_SIZE = 1 << 15;    // tiles per side
+const uint32_t TILEMAP_MAX_LAYERS = 64;
+const uint32_t TILEMAP_MAX_CHUNK_SIZE = 256; // tiles per chunk side
+
+// Binary tilemap file (.tmap), little-endian: this header, then one block per
+// chunk in row-major chunk order. A block holds each layer's tile ids as
+// chunkSize x chunkSize u16 rows, then, with TILEMAP_HAS_COLLISION, one bit
+// per tile. Chunks on the right and bottom edges are padded to full size
+// with EMPTY_TILE, so every block has the same size and a chunk is found by
+// multiplication alone.
+struct TilemapHeader {
+  char magic[4]; // "TMAP"
+  uint32_t version;
+  uint32_t width;
+  uint32_t height;
+  uint32_t layerCount;
+  uint32_t chunkSize;
+  uint32_t flags;
+  uint32_t reserved;
+};
+
+// A rectangle of chunks, bounds included.
+struct ChunkArea {
+  int firstX;
+  int firstY;
+  int lastX;
+  int lastY;
+};
+
+// Layers of tile ids, with optional per-tile collision. An id indexes the
+// tileset left to right, top to bottom. Loaded from a .tmap file the data is
+// memory mapped and used in place; CSV maps are converted to the same chunk
+// layout in memory.
+//
+// A .tmap can also be opened for streaming: then only the chunks asked for by
+// Stream are read, by a loader thread, and the least recently asked for are
+// dropped once the resident ones exceed the budget. Until a chunk arrives its
+// tiles read as EMPTY_TILE and are not solid.
+class Tilemap {
+private:
+  enum class ChunkState : unsigned char { Unloaded, Loading, Resident };
+
+  struct StreamedChunk {
+    std::unique_ptr<unsigned char[]> data;
+    ChunkState state = ChunkState::Unloaded;
+    unsigned int lastUsed = 0;
+  };
+
+  struct LoadedChunk {
+    unsigned int index;
+    std::unique_ptr<unsigned char[]> data;
+  };
+
+  std::string filePath;
+  int width = 0;
+  int height = 0;
+  int layerCount = 0;
+  int chunkSize = TILEMAP_CHUNK_SIZE;
+  int chunkColumns = 0;
+  int chunkRows = 0;
+  bool hasCollision = false;
+  size_t chunkStride = 0;
+
+  const unsigned char *chunks = nullptr;
+  std::vector<unsigned char> ownedChunks;
+  void *mapping = nullptr;
+  size_t mappingSize = 0;
+
+  // Streaming; only touched by the main thread.
+  bool isStreaming = false;
+  std::vector<StreamedChunk> streamedChunks;
+  std::vector<unsigned int> residentChunks;
+  size_t streamingBudget = 0;
+  unsigned int streamFrame = 0;
+
+  // Shared with the loader thread, guarded by mutex.
+  std::mutex mutex;
+  std::condition_variable jobAvailable;
+  std::deque<unsigned int> jobs;
+  std::vector<LoadedChunk> loaded;
+  bool isStopping = false;
+
+  std::thread loader;
+
+  void Reset();
+  void LoaderLoop(std::string filePath);
+  void EvictChunks();
+  void SetLayout(int width, int height, int layerCount, int chunkSize,
+                 bool hasCollision);
+  static bool ReadCsv(const std::string &filePath, std::vector<int> &cells,
+                      int &width, int &height);
+
+public:
+  Tilemap() = default;
+  ~Tilemap();
+
+  Tilemap(const Tilemap &) = delete;
+  Tilemap &operator=(const Tilemap &) = delete;
+
+  bool Load(const std::string &filePath);
+  bool LoadBinary(const std::string &filePath);
+  bool OpenStreaming(const std::string &filePath,
+                     size_t memoryBudget = TILEMAP_STREAMING_BUDGET);
+  // Comma-separated rows of ids, one row per line, one file per layer.
+  // Negative ids are empty. In the collision file any non-zero cell is solid.
+  bool LoadCsv(const std::vector<std::string> &layerFiles,
+               const std::string &collisionFile = "");
+  bool SaveBinary(const std::string &filePath) const;
+
+  // Keeps every chunk in the areas resident, asking for missing ones in the
+  // order given, and lets go of queued loads no longer asked for. Call once
+  // per frame with everything still needed; does nothing unless streaming.
+  void Stream(const std::vector<ChunkArea> &areas);
+
+  const std::string &GetFilePath() const { return filePath; }
+  int GetWidth() const { return width; }
+  int GetHeight() const { return height; }
+  int GetLayerCount() const { return layerCount; }
+  int GetChunkSize() const { return chunkSize; }
+  bool HasCollision() const { return hasCollision; }
+  int GetChunkColumns() const { return chunkColumns; }
+  int GetChunkRows() const { return chunkRows; }
+
+  bool IsStreaming() const { return isStreaming; }
+  size_t GetResidentBytes() const {
+    return isStreaming ? residentChunks.size() * chunkStride
+                       : static_cast<size_t>(chunkColumns) * chunkRows *
+                             chunkStride;
+  }
+
+  // Null while a streamed chunk is not resident.
+  const unsigned char *GetChunk(int chunkX, int chunkY) const {
+    const size_t index = static_cast<size_t>(chunkY) * chunkColumns + chunkX;
+    if (!isStreaming) {
+      return chunks + index * chunkStride;
+    }
+    return streamedChunks[index].data.get();
+  }
+
+  uint16_t GetTile(int x, int y, int layer = 0) const {
+    const auto tiles = reinterpret_cast<const uint16_t *>(
+        GetChunk(x / chunkSize, y / chunkSize));
+    if (!tiles) {
+      return EMPTY_TILE;
+    }
+    return tiles[(layer * chunkSize + y % chunkSize) * chunkSize +
+                 x % chunkSize];
+  }
+
+  bool IsSolid(int x, int y) const {
+    const unsigned char *chunk = GetChunk(x / chunkSize, y / chunkSize);
+    if (!hasCollision || !chunk) {
+      return false;
+    }
+    const unsigned char *bits =
+        chunk + layerCount * chunkSize * chunkSize * 2;
+    const int bit = (y % chunkSize) * chunkSize + x % chunkSize;
+    return (bits[bit >> 3] >> (bit & 7)) & 1;
+  }
+};
+
+#endif
@@ -0,0 +1,31 @@
+#include "../src/Renderer/TextureAtlas.h"
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <filesystem>
+#include <spdlog/spdlog.h>
+#include <string>
+
+// Usage: atlas-packer <image directory> <output prefix> [page size]
+int
+main(int argc, char *argv[]) {
+  if (argc < 3) {
+    spdlog::critical("Usage: atlas-packer <image directory> <output prefix> "
+                     "[page size]");
+    return 1;
+  }
+
+  const int pageSize = argc > 3 ? std::stoi(argv[3]) : ATLAS_PAGE_SIZE;
+
+  IMG_Init(IMG_INIT_PNG);
+
+  const auto outputDirectory = std::filesystem::path(argv[2]).parent_path();
+  if (!outputDirectory.empty()) {
+    std::filesystem::create_directories(outputDirectory);
+  }
+
+  TextureAtlas atlas;
+  const bool isPacked = atlas.Pack(argv[1], pageSize) && atlas.Save(argv[2]);
+
+  IMG_Quit();
+  return isPacked ? 0 : 1;
+}
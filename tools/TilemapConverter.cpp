@@ -0,0 +1,38 @@
+#include "../src/Tilemap/Tilemap.h"
+#include <spdlog/spdlog.h>
+#include <string>
+#include <vector>
+
+// Usage: tilemap-converter <output .tmap> <layer csv>... [--collision <csv>]
+int
+main(int argc, char *argv[]) {
+  std::vector<std::string> layerFiles;
+  std::string collisionFile;
+  for (int i = 2; i < argc; i++) {
+    const std::string argument = argv[i];
+    if (argument == "--collision" && i + 1 < argc) {
+      collisionFile = argv[++i];
+    } else {
+      layerFiles.push_back(argument);
+    }
+  }
+
+  if (argc < 3 || layerFiles.empty()) {
+    spdlog::critical("Usage: tilemap-converter <output .tmap> <layer csv>... "
+                     "[--collision <csv>]");
+    return 1;
+  }
+
+  Tilemap tilemap;
+  if (!tilemap.LoadCsv(layerFiles, collisionFile) ||
+      !tilemap.SaveBinary(argv[1])) {
+    return 1;
+  }
+
+  spdlog::info("Wrote " + std::string(argv[1]) + ": " +
+               std::to_string(tilemap.GetWidth()) + "x" +
+               std::to_string(tilemap.GetHeight()) + " tiles, " +
+               std::to_string(tilemap.GetLayerCount()) + " layer(s)" +
+               (tilemap.HasCollision() ? ", collision" : ""));
+  return 0;
+}